@@ -0,0 +1,30 @@
+/*
+ * action_ring.h
+ */
+
+#ifndef INC_ACTION_RING_H_
+#define INC_ACTION_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "input.h"
+
+#define ACTION_RING_SIZE 32 //power of two
+
+//Lock-free ring with a single producer and a single consumer, neither side ever waits for the other
+typedef struct {
+    _Atomic uint32_t head; //Events pushed, written only by the producer
+    _Atomic uint32_t tail; //Events popped, written only by the consumer
+    uint32_t dropped; //Events pushed while the ring was full, written only by the producer
+    input_event_t events[ACTION_RING_SIZE];
+} action_ring_t;
+
+void action_ring_init(action_ring_t* ring);
+bool action_ring_push(action_ring_t* ring, const input_event_t* event);
+bool action_ring_peek(action_ring_t* ring, input_event_t* event);
+bool action_ring_pop(action_ring_t* ring, input_event_t* event);
+bool action_ring_pop_oldest(action_ring_t* const rings[], size_t count, input_event_t* event);
+
+#endif /* INC_ACTION_RING_H_ */
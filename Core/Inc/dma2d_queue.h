@@ -0,0 +1,64 @@
+/*
+ * dma2d_queue.h
+ */
+
+#ifndef INC_DMA2D_QUEUE_H_
+#define INC_DMA2D_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DMA2D_QUEUE_SIZE 64
+#define DMA2D_STAGING_SIZE 8192
+#define DMA2D_FENCE_FLAG 0x00000100U
+
+//Pixel formats share their encoding with LCD_PIXEL_FORMAT_*, DMA2D_INPUT_* and DMA2D_OUTPUT_*
+#define DMA2D_FORMAT_ARGB8888 0U
+#define DMA2D_FORMAT_RGB565 2U
+#define DMA2D_FORMAT_L8 5U
+
+typedef enum {
+    DMA2D_CMD_FILL,
+    DMA2D_CMD_COPY,
+    DMA2D_CMD_CONVERT
+} dma2d_op_t;
+
+typedef struct {
+    dma2d_op_t op;
+    uintptr_t src;
+    uint32_t src_offset; //Pixels skipped at the end of each source line
+    uint32_t src_format;
+    uintptr_t dst;
+    uint32_t dst_offset; //Pixels skipped at the end of each destination line
+    uint32_t dst_format; //Programmed as the output format by fills and conversions, which cannot write L8
+    uint32_t color; //Fill color in the destination format
+    uint16_t width;
+    uint16_t height;
+} dma2d_cmd_t;
+
+typedef struct {
+    uint32_t commands; //Commands completed
+    uint64_t pixels; //Pixels written
+    uint64_t bytes; //Bytes read and written, the SDRAM traffic of the commands
+    uint64_t busy_cycles; //Cycles from the start to the completion of every command, nanoseconds on the host
+    uint32_t syncs; //Calls of dma2d_sync
+    uint32_t sync_waits; //Syncs that waited because a queued command touched the memory
+} dma2d_stats_t;
+
+void dma2d_queue_init(void);
+void dma2d_fill(uintptr_t dst, uint32_t dst_offset, uint32_t dst_format, uint32_t width, uint32_t height, uint32_t color);
+void dma2d_copy(uintptr_t src, uint32_t src_offset, uintptr_t dst, uint32_t dst_offset, uint32_t format, uint32_t width, uint32_t height);
+void dma2d_convert(uintptr_t src, uint32_t src_offset, uint32_t src_format, uintptr_t dst, uint32_t dst_offset, uint32_t dst_format, uint32_t width, uint32_t height);
+void* dma2d_stage(const void* data, uint32_t size);
+void dma2d_retain(uintptr_t start, uint32_t size);
+void dma2d_fence(void);
+void dma2d_sync(uintptr_t start, uint32_t size);
+bool dma2d_busy(void);
+void dma2d_irq_handler(void);
+#if !defined(USE_HAL_DRIVER)
+void dma2d_poll(void);
+#endif // !USE_HAL_DRIVER
+
+extern dma2d_stats_t dma2d_stats;
+
+#endif /* INC_DMA2D_QUEUE_H_ */
@@ -0,0 +1,95 @@
+/*
+ * input.h
+ */
+
+#ifndef INC_INPUT_H_
+#define INC_INPUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tetris.h"
+
+#define INPUT_TOUCH_FLAG 0x00000200U
+#define INPUT_REPEAT_FLAG 0x00000400U
+#define N_ACTIONS (PLAY_PAUSE + 1)
+#define INPUT_RELEASE_TIMEOUT 30 //Milliseconds without a touch report after which the panel is read to detect the release
+#ifndef INPUT_DEFAULT_MODE
+#define INPUT_DEFAULT_MODE INPUT_MODE_BUTTONS //Controls after reset, holding play/pause switches them at runtime
+#endif // INPUT_DEFAULT_MODE
+#define INPUT_MODE_HOLD_US 1000000 //Holding play/pause this long switches between the button and the gesture controls
+#define INPUT_TAP_TRAVEL 16 //Pixels a tap may move, a touch that moves farther is a swipe even if the controller missed it
+
+//Touches between the two columns of buttons are gestures in the gesture mode
+#define X_GESTURE_START (X_BTN_PADDING * 2 + X_BTN)
+#define X_GESTURE_END (LCD_DEFAULT_WIDTH - X_BTN_PADDING * 2 - X_BTN)
+
+typedef enum {
+    INPUT_MODE_BUTTONS, //Only the on-screen buttons
+    INPUT_MODE_GESTURES //Swipes and taps on the playing field as well as the buttons
+} input_mode_t;
+
+typedef enum {
+    INPUT_SOURCE_BUTTON,
+    INPUT_SOURCE_GESTURE,
+    N_INPUT_SOURCES
+} input_source_t;
+
+typedef enum {
+    INPUT_PRESS,
+    INPUT_RELEASE,
+    INPUT_REPEAT
+} input_event_type_t;
+
+typedef struct {
+    action_t action;
+    input_event_type_t type;
+    uint32_t timestamp; //Cycle counter at the interrupt that reported the touch, or when a repeat was due
+    input_source_t source;
+} input_event_t;
+
+typedef struct {
+    uint32_t delay_us; //Hold time before the first repeat, 0 disables repeating
+    uint32_t period_us; //Time between the following repeats, 0 repeats only once
+} input_repeat_t;
+
+typedef void (*input_emit_t)(const input_event_t* event);
+
+typedef struct {
+    uint32_t count; //Actions performed with a measured latency
+    uint32_t last_us; //Touch interrupt to performed action
+    uint32_t max_us;
+    uint64_t total_us;
+} input_latency_t;
+
+typedef struct {
+    uint32_t interrupts; //Touch reports signaled by the controller
+    uint32_t scans; //Reads of the touch state
+    uint32_t actions; //Presses emitted
+    uint32_t releases; //Releases emitted
+    uint32_t repeats; //Repeats emitted while a button was held
+    uint32_t max_touches; //Most touch points seen in one scan
+    uint32_t swipes; //Gestures recognized by the controller
+    uint32_t taps; //Touches on the playing field that ended without a gesture
+    uint32_t dropped; //Swipes without an action, either not recognized by the controller or a zoom
+    uint32_t mode_switches; //Long presses of play/pause that switched the controls
+    uint32_t gesture_us; //Time from touching the playing field to the recognized gesture, last one
+    input_latency_t latency[N_INPUT_SOURCES];
+} input_stats_t;
+
+extern input_stats_t input_stats;
+
+void input_init(input_emit_t emit);
+void input_touch_irq(void);
+void input_repeat_irq(void);
+bool input_wait(void);
+void input_scan(void);
+void input_repeat(uint32_t now);
+void input_set_repeat(action_t action, uint32_t delay_us, uint32_t period_us);
+void input_set_mode(input_mode_t mode);
+input_mode_t input_get_mode(void);
+bool input_touching(void);
+uint32_t input_timestamp(void);
+void input_performed(const input_event_t* event);
+uint32_t input_average_latency_us(input_source_t source);
+
+#endif /* INC_INPUT_H_ */
@@ -0,0 +1,42 @@
+/*
+ * label.h
+ */
+
+#ifndef INC_LABEL_H_
+#define INC_LABEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32_lcd.h"
+
+#define LABEL_TEXT_SIZE 32
+
+typedef struct {
+    const char* format; //printf format taking up to two long values
+    uint16_t x; //anchor as used by UTIL_LCD_DisplayStringAt
+    uint16_t y;
+    Text_AlignModeTypdef mode;
+    uint8_t* bitmap; //offscreen pixels in the frame buffer format
+    uint32_t capacity; //size of the bitmap in bytes
+    long values[2];
+    char text[LABEL_TEXT_SIZE];
+    uint16_t left; //left edge of the rasterized text
+    uint16_t width;
+    uint16_t height;
+    bool rasterized; //false if the text did not fit into the bitmap and is drawn glyph by glyph
+    uint32_t version; //incremented whenever the bitmap changes
+    uint32_t rasterizations;
+} label_t;
+
+//What a frame buffer holds of a label
+typedef struct {
+    uint32_t version;
+    uint16_t left;
+    uint16_t width;
+} label_state_t;
+
+bool label_update(label_t* label, long a, long b);
+void label_draw(const label_t* label, const label_state_t* previous);
+label_state_t label_state(const label_t* label);
+
+#endif /* INC_LABEL_H_ */
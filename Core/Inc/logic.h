@@ -0,0 +1,36 @@
+/*
+ * logic.h
+ */
+
+#ifndef INC_LOGIC_H_
+#define INC_LOGIC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "tetris.h"
+#include "action_ring.h"
+
+#define LOGIC_TICK_FLAG 0x00000800U
+#define LOGIC_PERIOD_US 10000 //Period of the tick timer, one unit of the game time
+#define LOGIC_JITTER_LIMIT_US 1000 //Steps that start later than this after their tick are counted as late
+
+typedef struct {
+    uint32_t ticks; //Tick timer interrupts
+    uint32_t steps; //Ticks simulated, trails ticks only while a step is pending
+    uint32_t late; //Steps that started more than LOGIC_JITTER_LIMIT_US after their oldest pending tick
+    uint32_t max_jitter_us; //Longest delay between a tick and its simulation
+    uint32_t max_step_us; //Longest logic step
+    uint32_t published; //Snapshots published by the logic task
+    uint32_t rendered; //Snapshots taken by the renderer
+    uint32_t skipped; //Snapshots replaced before the renderer took them
+} logic_stats_t;
+
+void logic_init(void);
+void logic_tick_irq(void);
+void logic_wait(void);
+void logic_step(action_ring_t* const rings[], size_t count);
+const snapshot_t* logic_snapshot(void);
+
+extern logic_stats_t logic_stats;
+
+#endif /* INC_LOGIC_H_ */
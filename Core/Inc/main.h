@@ -43,6 +43,13 @@ extern "C" {
 #include "stm32h750b_discovery_mmc.h"
 #include "stm32h750b_discovery_sdram.h"
 #include "stm32_lcd.h"
+#include "dma2d_queue.h"
+#include "input.h"
+#include "action_ring.h"
+#include "logic.h"
+#include "vsync.h"
+#include "swapchain.h"
+#include "palette.h"
 /* USER CODE END Includes */
 
 /* Exported types ------------------------------------------------------------*/
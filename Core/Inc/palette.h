@@ -0,0 +1,17 @@
+/*
+ * palette.h
+ */
+
+#ifndef INC_PALETTE_H_
+#define INC_PALETTE_H_
+
+#include <stdint.h>
+
+#define PALETTE_SIZE 12 //Black, white, the grays of the HUD and the buttons and colors[]
+
+void palette_init(void);
+void palette_set(uint8_t index, uint32_t color);
+uint8_t palette_index(uint32_t color);
+void palette_reload_irq(void);
+
+#endif /* INC_PALETTE_H_ */
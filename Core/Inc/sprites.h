@@ -0,0 +1,21 @@
+/*
+ * sprites.h
+ */
+
+#ifndef INC_SPRITES_H_
+#define INC_SPRITES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint8_t* pixels; //pixels in the frame buffer format
+    uint16_t width;
+    uint16_t height;
+} sprite_t;
+
+void sprite_atlas_init(uint8_t* memory, uint32_t size);
+bool sprite_capture(sprite_t* sprite, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+void sprite_draw(const sprite_t* sprite, uint16_t x, uint16_t y);
+
+#endif /* INC_SPRITES_H_ */
@@ -30,8 +30,23 @@
 /* COM define */
 #define USE_COM_LOG                         0U
 
+//Pixel format of the frame buffers and the background, RGB565 halves the SDRAM traffic of drawing and scan out and
+//L8 quarters it by storing indices into the palette
+#ifndef LCD_FRAME_FORMAT
+#define LCD_FRAME_FORMAT                    LCD_PIXEL_FORMAT_ARGB8888
+#endif
 #define LCD_LAYER_0_ADDRESS                 0xD0000000U
 #define LCD_LAYER_1_ADDRESS                 0xD0200000U
+#define LCD_LAYER_2_ADDRESS                 0xD0600000U
+#define LCD_BACKGROUND_ADDRESS              0xD0800000U
+#define USE_DMA2D_TO_FILL_RGB_RECT          1U
+#define LCD_GLYPH_CACHE_ADDRESS             0xD0400000U
+#define LCD_GLYPH_CACHE_SIZE                0x00048000U
+#define LCD_LABEL_ADDRESS                   0xD0448000U
+//Bitmap of each label, room for LABEL_TEXT_SIZE - 1 characters of Font12 at 4 bytes per pixel
+#define LCD_LABEL_SIZE                      0x00003000U
+#define LCD_SPRITE_ADDRESS                  0xD044E000U
+#define LCD_SPRITE_SIZE                     0x00040000U
 
 /* Audio codecs defines */
 #define USE_AUDIO_CODEC_WM8994              1U
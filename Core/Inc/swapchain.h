@@ -0,0 +1,35 @@
+/*
+ * swapchain.h
+ */
+
+#ifndef INC_SWAPCHAIN_H_
+#define INC_SWAPCHAIN_H_
+
+#include <stdint.h>
+#include "tetris.h"
+
+#define SWAPCHAIN_BLANKING_FLAG 0x00001000U
+
+typedef enum {
+    SWAP_FREE, //Owned by nobody, can be acquired
+    SWAP_DRAWING, //Owned by the renderer
+    SWAP_READY, //Latest presented, the display switches to it at the next vertical blanking
+    SWAP_SCANOUT //On the screen
+} swap_state_t;
+
+typedef struct {
+    uint32_t acquires;
+    uint32_t presents;
+    uint32_t dropped; //Presented frames replaced by a newer one before they reached the screen
+} swapchain_stats_t;
+
+void swapchain_init(void);
+uint32_t swapchain_acquire(void);
+void swapchain_present(uint32_t buffer);
+void swapchain_wait(void);
+uint32_t swapchain_front_buffer(void);
+void swapchain_blanking_irq(void);
+
+extern swapchain_stats_t swapchain_stats;
+
+#endif /* INC_SWAPCHAIN_H_ */
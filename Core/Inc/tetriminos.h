@@ -0,0 +1,25 @@
+/*
+ * tetriminos.h
+ */
+
+#ifndef INC_TETRIMINOS_H_
+#define INC_TETRIMINOS_H_
+
+#include "tetris.h"
+#include <inttypes.h>
+
+//Horizontal positions of the 4x4 box that keep at least one of its columns inside the walls
+#define X_POSITIONS (X_DIM + X_WALL)
+
+typedef struct {
+    uint16_t rows[X_POSITIONS][4];  //Row masks aligned to the occupancy rows, indexed by x + X_WALL
+    int8_t left;                    //First occupied column of the 4x4 box
+    int8_t right;                   //Last occupied column of the 4x4 box
+    int8_t bottom;                  //First occupied row of the 4x4 box
+    int8_t top;                     //Last occupied row of the 4x4 box
+} tetrimino_masks_t;
+
+extern const uint16_t tetriminos[8][4];
+extern const tetrimino_masks_t tetrimino_masks[8][4];
+
+#endif /* INC_TETRIMINOS_H_ */
@@ -44,8 +44,22 @@
 #define Y_START (LCD_DEFAULT_HEIGHT - Y_BOX * 2)
 #define X_BORDER (X_DIM + 1)
 #define Y_BORDER (Y_DIM + 1)
+#define Y_FRAME (Y_DIM + 1)
+#define N_FRAME_BUFFERS 3 //One on the screen, one presented and one drawn into
+#define BACKGROUND_LAYER 0 //Border and button frames, drawn once
+#define FOREGROUND_LAYER 1 //Frame buffers of the swap chain, their black pixels show the background layer
+#define TRANSPARENT_COLOR UTIL_LCD_COLOR_BLACK //Color key of the foreground layer
+
+//Occupancy rows of the playing field keep the walls in the X_WALL bits on either side of the X_DIM columns
+#define X_WALL 3
+#define FULL_ROW 0xffff
+#define EMPTY_ROW ((uint16_t)~(((1 << X_DIM) - 1) << X_WALL))
 
 #include "polygons.h"
+#include "tetriminos.h"
+#include "label.h"
+#include "sprites.h"
+#include "dma2d_queue.h"
 #include "stm32_lcd.h"
 #include "stm32h750b_discovery_lcd.h"
 #include "stm32h750b_discovery_mmc.h"
@@ -86,13 +100,48 @@ typedef struct {
     polygon_t polygon;
 } button_t;
 
+typedef enum {
+    BANNER_NONE,
+    BANNER_GAME_OVER,
+    BANNER_SCORES
+} banner_t;
+
+//Everything the renderer needs of the game, published by the logic task and never changed afterwards
+typedef struct {
+    uint8_t cells[Y_FRAME][X_DIM]; //Placed boxes with the falling tetrimino
+    uint8_t buttons[N_BTN]; //Pressed state in bit 0, selected polygon in bit 1
+    uint32_t time;
+    uint32_t score;
+    uint32_t level;
+    uint32_t top_scores[N_TOP_SCORES];
+    banner_t banner;
+    uint32_t sequence; //Logic step that published the snapshot
+} snapshot_t;
+
+typedef struct {
+    uint8_t cells[Y_FRAME][X_DIM];
+    uint8_t buttons[N_BTN];
+    label_state_t time;
+    label_state_t score;
+    banner_t banner;
+    bool valid;
+} frame_t;
+
 void clear_lines(void);
 void perform_action(const action_t action);
-void render(void);
+void render(uint32_t buffer, const snapshot_t* snapshot);
+void take_snapshot(snapshot_t* snapshot);
+void init_sprites(void);
 void reset_game(void);
 void update_state(void);
 void tick(void);
 
+extern const uint32_t colors[8];
 extern button_t buttons[N_BTN];
+extern bool game_over;
+extern uint32_t score;
+extern uint32_t level;
+extern uint32_t button_polygon_cycles;
+extern uint32_t button_sprite_cycles;
 
 #endif /* INC_TETRIS_H_ */
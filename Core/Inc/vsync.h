@@ -0,0 +1,30 @@
+/*
+ * vsync.h
+ */
+
+#ifndef INC_VSYNC_H_
+#define INC_VSYNC_H_
+
+#include <stdint.h>
+
+#define VSYNC_HOST_REFRESH_US 16667 //The host has no display timings, it presents as if at 60 Hz
+
+typedef struct {
+    uint32_t presents; //Frames handed to the display
+    uint32_t reloads; //Frames the display switched to
+    uint32_t missed; //Refreshes that showed the previous frame again because the next one was not ready in time
+    uint32_t duplicated; //Frames presented with the same content as the frame before them
+    uint32_t refresh_us; //Refresh period of the display
+    uint32_t last_interval_us; //Time between the last two reloads
+    uint32_t min_interval_us;
+    uint32_t max_interval_us;
+    uint64_t total_interval_us; //Sum of the intervals, divided by reloads - 1 gives the average
+} vsync_stats_t;
+
+void vsync_init(void);
+void vsync_present(uint32_t tag);
+void vsync_reload(void);
+
+extern vsync_stats_t vsync_stats;
+
+#endif /* INC_VSYNC_H_ */
@@ -0,0 +1,85 @@
+/*
+ * action_ring.c
+ */
+#include "action_ring.h"
+
+#define ACTION_RING_MASK (ACTION_RING_SIZE - 1)
+
+/// <summary>
+/// Empties the ring, must not be used while the producer or the consumer is running
+/// </summary>
+/// <param name="ring">to initialize</param>
+void action_ring_init(action_ring_t* ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->dropped = 0;
+}
+
+/// <summary>
+/// Adds an event, called only by the producer of the ring, also from an interrupt
+/// </summary>
+/// <param name="ring">to push to</param>
+/// <param name="event">to copy into the ring</param>
+/// <returns>false if the ring was full and the event was dropped</returns>
+bool action_ring_push(action_ring_t* ring, const input_event_t* event) {
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == ACTION_RING_SIZE) {
+        ++ring->dropped;
+        return false;
+    }
+    ring->events[head & ACTION_RING_MASK] = *event;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release); //Publishes the event
+    return true;
+}
+
+/// <summary>
+/// Reads the oldest event without removing it, called only by the consumer of the ring
+/// </summary>
+/// <param name="ring">to read from</param>
+/// <param name="event">where the event is copied</param>
+/// <returns>false if the ring is empty</returns>
+bool action_ring_peek(action_ring_t* ring, input_event_t* event) {
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *event = ring->events[tail & ACTION_RING_MASK];
+    return true;
+}
+
+/// <summary>
+/// Removes the oldest event, called only by the consumer of the ring
+/// </summary>
+/// <param name="ring">to pop from</param>
+/// <param name="event">where the event is copied</param>
+/// <returns>false if the ring is empty</returns>
+bool action_ring_pop(action_ring_t* ring, input_event_t* event) {
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (!action_ring_peek(ring, event)) {
+        return false;
+    }
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release); //Hands the slot back to the producer
+    return true;
+}
+
+/// <summary>
+/// Removes the event with the earliest timestamp from the heads of several rings, merging their producers in time order
+/// </summary>
+/// <param name="rings">to pop from, the caller is the consumer of all of them</param>
+/// <param name="count">number of rings</param>
+/// <param name="event">where the event is copied</param>
+/// <returns>false if all the rings are empty</returns>
+bool action_ring_pop_oldest(action_ring_t* const rings[], size_t count, input_event_t* event) {
+    size_t oldest = count;
+    input_event_t candidate;
+    for (size_t i = 0; i < count; ++i) {
+        if (action_ring_peek(rings[i], &candidate) &&
+            (oldest == count || (int32_t)(candidate.timestamp - event->timestamp) < 0)) {
+            *event = candidate;
+            oldest = i;
+        }
+    }
+    return oldest != count && action_ring_pop(rings[oldest], event);
+}
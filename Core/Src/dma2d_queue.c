@@ -0,0 +1,453 @@
+/*
+ * dma2d_queue.c
+ */
+#include "dma2d_queue.h"
+#include "main.h"
+#include <string.h>
+
+#if defined(USE_HAL_DRIVER)
+#include "cmsis_os.h"
+
+#define LOCK() NVIC_DisableIRQ(DMA2D_IRQn)
+#define UNLOCK() NVIC_EnableIRQ(DMA2D_IRQn)
+#else
+#define LOCK()
+#define UNLOCK()
+#endif // USE_HAL_DRIVER
+
+static dma2d_cmd_t queue[DMA2D_QUEUE_SIZE];
+static volatile uint32_t head = 0; //Next free slot, written by the producer
+static volatile uint32_t tail = 0; //Command being executed, written by the interrupt
+static volatile bool running = false;
+static void* volatile waiter = NULL;
+
+static uint32_t staging[DMA2D_STAGING_SIZE / sizeof(uint32_t)];
+static uint32_t staging_used = 0;
+static uintptr_t retained_start = 0;
+static uintptr_t retained_end = 0;
+static uint32_t started = 0; //Cycle counter when the current command started
+
+uint32_t dma2d_errors = 0;
+dma2d_stats_t dma2d_stats = { 0 };
+
+static uint32_t bytes_per_pixel(uint32_t format) {
+    return (format == DMA2D_FORMAT_RGB565) ? 2 : (format == DMA2D_FORMAT_L8) ? 1 : 4;
+}
+
+#if defined(USE_HAL_DRIVER)
+/// <summary>
+/// Programs the DMA2D registers for the command and starts the transfer
+/// </summary>
+/// <param name="cmd">Command to execute</param>
+static void start(const dma2d_cmd_t* cmd) {
+    uint32_t mode;
+    started = DWT->CYCCNT;
+    DMA2D->OMAR = cmd->dst;
+    DMA2D->OOR = cmd->dst_offset;
+    DMA2D->NLR = ((uint32_t)cmd->width << DMA2D_NLR_PL_Pos) | ((uint32_t)cmd->height << DMA2D_NLR_NL_Pos);
+    switch (cmd->op) {
+        case DMA2D_CMD_FILL:
+            DMA2D->OPFCCR = cmd->dst_format;
+            DMA2D->OCOLR = cmd->color;
+            mode = DMA2D_R2M;
+            break;
+        case DMA2D_CMD_COPY:
+            //Memory to memory takes the pixel size from the foreground format and ignores the output format, which
+            //has no L8, so L8 indices are copied byte by byte
+            DMA2D->FGMAR = cmd->src;
+            DMA2D->FGOR = cmd->src_offset;
+            DMA2D->FGPFCCR = cmd->src_format;
+            mode = DMA2D_M2M;
+            break;
+        case DMA2D_CMD_CONVERT:
+        default:
+            DMA2D->OPFCCR = cmd->dst_format;
+            DMA2D->FGMAR = cmd->src;
+            DMA2D->FGOR = cmd->src_offset;
+            DMA2D->FGPFCCR = cmd->src_format | (0xffU << DMA2D_FGPFCCR_ALPHA_Pos);
+            mode = DMA2D_M2M_PFC;
+            break;
+    }
+    DMA2D->CR = mode | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_START;
+}
+
+/// <summary>
+/// Wakes up the task waiting in dma2d_fence or on a full queue
+/// </summary>
+static void notify(void) {
+    if (waiter) {
+        osThreadFlagsSet((osThreadId_t)waiter, DMA2D_FENCE_FLAG);
+    }
+}
+
+/// <summary>
+/// Blocks while the condition holds, the interrupt wakes the task up whenever it retires a command
+/// </summary>
+/// <param name="pending">Condition to wait on</param>
+static void wait_while(bool (*pending)(void)) {
+    //The waiter is published before the condition is checked so that no completion can be missed
+    const bool blocking = osKernelGetState() == osKernelRunning;
+    if (blocking) {
+        waiter = osThreadGetId();
+    }
+    while (pending()) {
+        if (blocking) {
+            osThreadFlagsWait(DMA2D_FENCE_FLAG, osFlagsWaitAny, osWaitForever);
+        }
+    }
+    waiter = NULL;
+}
+#else
+static uint32_t read_pixel(const uint8_t* p, uint32_t format) {
+    switch (format) {
+        case DMA2D_FORMAT_RGB565: {
+            const uint32_t c = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+            const uint32_t r = (c >> 11) & 0x1f, g = (c >> 5) & 0x3f, b = c & 0x1f;
+            return 0xff000000U | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+        }
+        case DMA2D_FORMAT_L8:
+            return p[0];
+        case DMA2D_FORMAT_ARGB8888:
+        default:
+            return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+}
+
+static void write_pixel(uint8_t* p, uint32_t format, uint32_t color) {
+    switch (format) {
+        case DMA2D_FORMAT_RGB565:
+            p[0] = (uint8_t)color;
+            p[1] = (uint8_t)(color >> 8);
+            break;
+        case DMA2D_FORMAT_L8:
+            p[0] = (uint8_t)color;
+            break;
+        case DMA2D_FORMAT_ARGB8888:
+        default:
+            p[0] = (uint8_t)color;
+            p[1] = (uint8_t)(color >> 8);
+            p[2] = (uint8_t)(color >> 16);
+            p[3] = (uint8_t)(color >> 24);
+            break;
+    }
+}
+
+/// <summary>
+/// Software stand-in for the DMA2D, used when the queue is built without the HAL
+/// </summary>
+/// <param name="cmd">Command to execute</param>
+static void start(const dma2d_cmd_t* cmd) {
+    started = DWT->CYCCNT;
+    if (cmd->op != DMA2D_CMD_COPY && cmd->dst_format == DMA2D_FORMAT_L8) {
+        ++dma2d_errors; //The output format has no L8, the DMA2D raises a configuration error
+        return;
+    }
+    const uint32_t src_bpp = bytes_per_pixel(cmd->src_format);
+    const uint32_t dst_bpp = bytes_per_pixel(cmd->dst_format);
+    for (uint32_t y = 0; y < cmd->height; ++y) {
+        uint8_t* dst = (uint8_t*)cmd->dst + y * (cmd->width + cmd->dst_offset) * dst_bpp;
+        const uint8_t* src = (const uint8_t*)cmd->src + y * (cmd->width + cmd->src_offset) * src_bpp;
+        for (uint32_t x = 0; x < cmd->width; ++x, dst += dst_bpp, src += src_bpp) {
+            switch (cmd->op) {
+                case DMA2D_CMD_FILL:
+                    write_pixel(dst, cmd->dst_format, cmd->color);
+                    break;
+                case DMA2D_CMD_COPY:
+                    memcpy(dst, src, dst_bpp);
+                    break;
+                case DMA2D_CMD_CONVERT:
+                default: {
+                    uint32_t c = read_pixel(src, cmd->src_format);
+                    if (cmd->dst_format == DMA2D_FORMAT_RGB565) {
+                        c = ((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f);
+                    }
+                    write_pixel(dst, cmd->dst_format, c);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void notify(void) {
+}
+
+static void wait_while(bool (*pending)(void)) {
+    while (pending()) {
+        dma2d_irq_handler();
+    }
+}
+
+/// <summary>
+/// Executes every pending command, in order
+/// </summary>
+void dma2d_poll(void) {
+    while (running) {
+        dma2d_irq_handler();
+    }
+}
+#endif // USE_HAL_DRIVER
+
+/// <summary>
+/// Initializes the queue and enables the DMA2D interrupt
+/// </summary>
+void dma2d_queue_init(void) {
+    head = tail = 0;
+    running = false;
+    staging_used = 0;
+#if defined(USE_HAL_DRIVER)
+    __HAL_RCC_DMA2D_CLK_ENABLE();
+    HAL_NVIC_SetPriority(DMA2D_IRQn, 10, 10);
+    HAL_NVIC_EnableIRQ(DMA2D_IRQn);
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Adds the time the command kept the DMA2D busy and the memory it read and wrote to the statistics
+/// </summary>
+/// <param name="cmd">Command that completed</param>
+static void account(const dma2d_cmd_t* cmd) {
+    const uint32_t pixels = (uint32_t)cmd->width * cmd->height;
+    ++dma2d_stats.commands;
+    dma2d_stats.pixels += pixels;
+    dma2d_stats.busy_cycles += DWT->CYCCNT - started;
+    dma2d_stats.bytes += pixels * bytes_per_pixel(cmd->dst_format);
+    if (cmd->op != DMA2D_CMD_FILL) {
+        dma2d_stats.bytes += pixels * bytes_per_pixel(cmd->src_format);
+    }
+}
+
+/// <summary>
+/// Retires the current command and starts the next one
+/// </summary>
+void dma2d_irq_handler(void) {
+#if defined(USE_HAL_DRIVER)
+    const uint32_t isr = DMA2D->ISR;
+    DMA2D->IFCR = isr & (DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF);
+    if (isr & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+        ++dma2d_errors;
+    }
+#else
+    if (running) {
+        start(&queue[tail]); //The software DMA2D completes the command "in the interrupt"
+    }
+#endif // USE_HAL_DRIVER
+    if (!running) {
+        return;
+    }
+    account(&queue[tail]);
+    tail = (tail + 1) % DMA2D_QUEUE_SIZE;
+    if (tail != head) {
+#if defined(USE_HAL_DRIVER)
+        start(&queue[tail]);
+#endif // USE_HAL_DRIVER
+    } else {
+        running = false;
+    }
+    notify();
+}
+
+static bool queue_full(void) {
+    return (head + 1) % DMA2D_QUEUE_SIZE == tail;
+}
+
+/// <summary>
+/// Appends the command to the queue and starts the DMA2D if it is idle
+/// </summary>
+/// <param name="cmd">Command to append</param>
+static void push(const dma2d_cmd_t* cmd) {
+    wait_while(queue_full);
+    queue[head] = *cmd;
+    LOCK();
+    head = (head + 1) % DMA2D_QUEUE_SIZE;
+    if (!running) {
+        running = true;
+#if defined(USE_HAL_DRIVER)
+        start(&queue[tail]);
+#endif // USE_HAL_DRIVER
+    }
+    UNLOCK();
+}
+
+/// <summary>
+/// Queues a copy of a staged column of the color index, used for the odd pixels of an L8 fill
+/// </summary>
+/// <param name="dst">Address of the top pixel</param>
+/// <param name="pitch">Bytes from one line to the next</param>
+/// <param name="height">Height of the column</param>
+/// <param name="index">Color index</param>
+static void fill_l8_column(uintptr_t dst, uint32_t pitch, uint32_t height, uint8_t index) {
+    uint8_t column[256];
+    const uint32_t lines = (height < sizeof(column)) ? height : sizeof(column);
+    memset(column, index, lines);
+    for (uint32_t y = 0; y < height; y += lines) {
+        const uint32_t count = (height - y < lines) ? height - y : lines;
+        void* staged = dma2d_stage(column, count);
+        dma2d_copy((uintptr_t)staged, 0, dst + y * pitch, pitch - 1, DMA2D_FORMAT_L8, 1, count);
+    }
+}
+
+/// <summary>
+/// Fills an L8 rectangle, which the DMA2D cannot output, as RGB565 pixels that hold two indices each. The odd
+/// columns at the edges are copied from a staged column
+/// </summary>
+/// <param name="dst">Address of the first pixel</param>
+/// <param name="dst_offset">Pixels between the end of one line and the start of the next</param>
+/// <param name="width">Width of the rectangle</param>
+/// <param name="height">Height of the rectangle</param>
+/// <param name="index">Color index</param>
+static void fill_l8(uintptr_t dst, uint32_t dst_offset, uint32_t width, uint32_t height, uint8_t index) {
+    const uint32_t pitch = width + dst_offset;
+    if (width == 0 || height == 0) {
+        return;
+    }
+    if (pitch & 1) {
+        //Lines alternate their alignment, every pixel is a column
+        for (uint32_t x = 0; x < width; ++x) {
+            fill_l8_column(dst + x, pitch, height, index);
+        }
+        return;
+    }
+    if (dst & 1) {
+        fill_l8_column(dst++, pitch, height, index);
+        --width;
+    }
+    const uint32_t pairs = width / 2;
+    if (pairs != 0) {
+        const dma2d_cmd_t cmd = { .op = DMA2D_CMD_FILL, .dst = dst, .dst_offset = (pitch / 2) - pairs,
+            .dst_format = DMA2D_FORMAT_RGB565, .color = index * 0x0101U, .width = pairs, .height = height };
+        push(&cmd);
+    }
+    if (width & 1) {
+        fill_l8_column(dst + width - 1, pitch, height, index);
+    }
+}
+
+/// <summary>
+/// Queues a fill of the rectangle with a solid color
+/// </summary>
+/// <param name="dst">Address of the first pixel</param>
+/// <param name="dst_offset">Pixels between the end of one line and the start of the next</param>
+/// <param name="dst_format">Pixel format of the destination</param>
+/// <param name="width">Width of the rectangle</param>
+/// <param name="height">Height of the rectangle</param>
+/// <param name="color">Color in the destination pixel format</param>
+void dma2d_fill(uintptr_t dst, uint32_t dst_offset, uint32_t dst_format, uint32_t width, uint32_t height, uint32_t color) {
+    if (dst_format == DMA2D_FORMAT_L8) {
+        fill_l8(dst, dst_offset, width, height, (uint8_t)color);
+        return;
+    }
+    const dma2d_cmd_t cmd = { .op = DMA2D_CMD_FILL, .dst = dst, .dst_offset = dst_offset, .dst_format = dst_format,
+        .color = color, .width = width, .height = height };
+    push(&cmd);
+}
+
+/// <summary>
+/// Queues a copy between two buffers with the same pixel format
+/// </summary>
+void dma2d_copy(uintptr_t src, uint32_t src_offset, uintptr_t dst, uint32_t dst_offset, uint32_t format, uint32_t width, uint32_t height) {
+    const dma2d_cmd_t cmd = { .op = DMA2D_CMD_COPY, .src = src, .src_offset = src_offset, .src_format = format,
+        .dst = dst, .dst_offset = dst_offset, .dst_format = format, .width = width, .height = height };
+    push(&cmd);
+}
+
+/// <summary>
+/// Queues a copy that converts the pixels from the source to the destination format
+/// </summary>
+void dma2d_convert(uintptr_t src, uint32_t src_offset, uint32_t src_format, uintptr_t dst, uint32_t dst_offset, uint32_t dst_format, uint32_t width, uint32_t height) {
+    const dma2d_cmd_t cmd = { .op = DMA2D_CMD_CONVERT, .src = src, .src_offset = src_offset, .src_format = src_format,
+        .dst = dst, .dst_offset = dst_offset, .dst_format = dst_format, .width = width, .height = height };
+    push(&cmd);
+}
+
+/// <summary>
+/// Copies the data into memory that stays valid until the queued commands that read it complete
+/// </summary>
+/// <param name="data">Data to copy</param>
+/// <param name="size">Size of the data in bytes</param>
+/// <returns>Staged copy of the data or NULL if the data does not fit into the staging memory</returns>
+void* dma2d_stage(const void* data, uint32_t size) {
+    if ((uintptr_t)data >= retained_start && (uintptr_t)data + size <= retained_end) {
+        return (void*)data; //Retained data outlives the commands, no copy needed
+    }
+    const uint32_t aligned = (size + 3) & ~3U;
+    if (aligned > DMA2D_STAGING_SIZE) {
+        return NULL;
+    }
+    if (!running) {
+        staging_used = 0;
+    } else if (staging_used + aligned > DMA2D_STAGING_SIZE) {
+        dma2d_fence();
+    }
+    void* staged = (uint8_t*)staging + staging_used;
+    memcpy(staged, data, size);
+    staging_used += aligned;
+    return staged;
+}
+
+/// <summary>
+/// Declares memory that is only modified after a fence, data from it is queued without staging
+/// </summary>
+/// <param name="start">Address of the memory</param>
+/// <param name="size">Size of the memory in bytes</param>
+void dma2d_retain(uintptr_t start, uint32_t size) {
+    retained_start = start;
+    retained_end = start + size;
+}
+
+/// <summary>
+/// Waits until every queued command completes
+/// </summary>
+void dma2d_fence(void) {
+    wait_while(dma2d_busy);
+    staging_used = 0;
+}
+
+/// <summary>
+/// Checks if a rectangle of a command covers any byte of the memory, a rectangle is treated as the span from its first
+/// to its last byte
+/// </summary>
+/// <param name="cmd">command the rectangle belongs to</param>
+/// <param name="address">first pixel of the rectangle</param>
+/// <param name="offset">pixels skipped at the end of each line</param>
+/// <param name="format">pixel format of the rectangle</param>
+/// <param name="start">first byte of the memory</param>
+/// <param name="end">byte after the memory</param>
+/// <returns>true if the rectangle may read or write the memory</returns>
+static bool covers(const dma2d_cmd_t* cmd, uintptr_t address, uint32_t offset, uint32_t format, uintptr_t start, uintptr_t end) {
+    if (cmd->width == 0 || cmd->height == 0) {
+        return false;
+    }
+    const uintptr_t last = address + ((cmd->height - 1U) * (cmd->width + offset) + cmd->width) * bytes_per_pixel(format);
+    return address < end && start < last;
+}
+
+/// <summary>
+/// Waits until no queued command reads or writes the memory, so the CPU can write it. Memory that no queued command
+/// touches is written without waiting for the DMA2D
+/// </summary>
+/// <param name="start">Address of the memory</param>
+/// <param name="size">Size of the memory in bytes</param>
+void dma2d_sync(uintptr_t start, uint32_t size) {
+    const uintptr_t end = start + size;
+    const uint32_t last = head;
+    ++dma2d_stats.syncs;
+    //Commands retired by the interrupt during the search are still checked, which only makes the search conservative
+    for (uint32_t i = tail; running && i != last; i = (i + 1) % DMA2D_QUEUE_SIZE) {
+        const dma2d_cmd_t* cmd = &queue[i];
+        if (covers(cmd, cmd->dst, cmd->dst_offset, cmd->dst_format, start, end) ||
+            (cmd->op != DMA2D_CMD_FILL && covers(cmd, cmd->src, cmd->src_offset, cmd->src_format, start, end))) {
+            ++dma2d_stats.sync_waits;
+            dma2d_fence();
+            return;
+        }
+    }
+}
+
+/// <summary>
+/// Checks if the DMA2D still has queued commands
+/// </summary>
+/// <returns>True if commands are pending</returns>
+bool dma2d_busy(void) {
+    return running;
+}
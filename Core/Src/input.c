@@ -0,0 +1,382 @@
+/*
+ * input.c
+ */
+#include "input.h"
+#include "main.h"
+#include <stdlib.h>
+
+#if defined(USE_HAL_DRIVER)
+#include "cmsis_os.h"
+
+#define CYCLES_PER_US (SystemCoreClock / 1000000U)
+#define LOCK() NVIC_DisableIRQ(TS_INT_EXTI_IRQn)
+#define UNLOCK() NVIC_EnableIRQ(TS_INT_EXTI_IRQn)
+#else
+#define CYCLES_PER_US 1000U //The host cycle counter counts nanoseconds
+#define LOCK()
+#define UNLOCK()
+#endif // USE_HAL_DRIVER
+
+static input_emit_t emit = NULL;
+static void* volatile task = NULL;
+static volatile bool pending = false; //A touch report arrived since the last scan
+static volatile uint32_t pending_timestamp = 0; //Time of the first report since the last scan
+static bool touching = false;
+static input_mode_t mode = INPUT_DEFAULT_MODE;
+
+//Actions of the gestures recognized by the controller, indexed by GESTURE_ID_*, a tap rotates right and the zooms
+//are dropped
+static const int8_t gesture_actions[GESTURE_ID_NB_MAX] = { -1, ROTATE_LEFT, MOVE_RIGHT, DROP, MOVE_LEFT, -1, -1 };
+static bool gesture_active = false; //A touch on the playing field is in progress
+static bool gesture_done = false; //Its gesture was already emitted or dropped
+static bool gesture_moved = false; //The touch left the tap radius, so it cannot end as a tap
+static uint32_t gesture_start = 0;
+static uint16_t gesture_x = 0; //Where the touch started
+static uint16_t gesture_y = 0;
+
+//Delayed auto shift and auto repeat, only the moves repeat by default. The single repeat of play/pause is the long
+//press that switches the controls
+static input_repeat_t repeat_config[N_ACTIONS] = {
+    [MOVE_LEFT] = { 170000, 50000 },
+    [MOVE_RIGHT] = { 170000, 50000 },
+    [PLAY_PAUSE] = { INPUT_MODE_HOLD_US, 0 }
+};
+static bool repeat_armed[N_BTN];
+static uint32_t repeat_deadline[N_BTN]; //Cycle counter at which the next repeat of the held button is due
+
+input_stats_t input_stats = { 0 };
+
+/// <summary>
+/// Sets the function that receives the actions, the calling task is the one woken up by the touch interrupt
+/// </summary>
+/// <param name="emit_action">called with every action and the time of the touch that caused it</param>
+void input_init(input_emit_t emit_action) {
+    emit = emit_action;
+#if defined(USE_HAL_DRIVER)
+    task = osThreadGetId();
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Records the time of the touch report and wakes up the input task, called from the touch interrupt
+/// </summary>
+/// <param name=""></param>
+void input_touch_irq(void) {
+    if (!pending) {
+        pending_timestamp = DWT->CYCCNT;
+        pending = true;
+    }
+    ++input_stats.interrupts;
+#if defined(USE_HAL_DRIVER)
+    if (task) {
+        osThreadFlagsSet((osThreadId_t)task, INPUT_TOUCH_FLAG);
+    }
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Wakes up the input task when the next repeat is due, called from the interrupt of the repeat timer
+/// </summary>
+/// <param name=""></param>
+void input_repeat_irq(void) {
+#if defined(USE_HAL_DRIVER)
+    if (task) {
+        osThreadFlagsSet((osThreadId_t)task, INPUT_REPEAT_FLAG);
+    }
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Finds the earliest repeat that is due
+/// </summary>
+/// <param name="deadline">where the cycle counter of the repeat is stored</param>
+/// <returns>true if a button is repeating</returns>
+static bool next_deadline(uint32_t* deadline) {
+    bool found = false;
+    for (size_t i = 0; i < N_BTN; ++i) {
+        if (repeat_armed[i] && (!found || (int32_t)(repeat_deadline[i] - *deadline) < 0)) {
+            *deadline = repeat_deadline[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+#if defined(USE_HAL_DRIVER)
+/// <summary>
+/// Starts the one pulse repeat timer, TIM5 counts microseconds and stops at its update event
+/// </summary>
+/// <param name="us">time until the interrupt</param>
+static void arm_repeat_timer(uint32_t us) {
+    TIM5->CR1 &= ~TIM_CR1_CEN;
+    TIM5->SR = ~TIM_SR_UIF;
+    TIM5->CNT = 0;
+    TIM5->ARR = MAX(us, 1U);
+    TIM5->CR1 |= TIM_CR1_CEN;
+}
+#endif // USE_HAL_DRIVER
+
+/// <summary>
+/// Blocks until the controller reports a touch or the next repeat is due, while the panel is touched it also returns
+/// after the release timeout because the controller stops reporting once the finger is lifted
+/// </summary>
+/// <param name=""></param>
+/// <returns>true if the touch state has to be read, false if only repeats are due</returns>
+bool input_wait(void) {
+#if defined(USE_HAL_DRIVER)
+    uint32_t deadline = 0;
+    if (next_deadline(&deadline)) {
+        const int32_t remaining = (int32_t)(deadline - DWT->CYCCNT);
+        if (remaining <= 0) {
+            return false;
+        }
+        arm_repeat_timer(remaining / CYCLES_PER_US);
+    }
+    const uint32_t flags = osThreadFlagsWait(INPUT_TOUCH_FLAG | INPUT_REPEAT_FLAG, osFlagsWaitAny,
+        touching ? INPUT_RELEASE_TIMEOUT : osWaitForever);
+    return (flags & osFlagsError) != 0 || (flags & INPUT_TOUCH_FLAG) != 0;
+#else
+    return true;
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Checks if any of the touch points is inside the button
+/// </summary>
+/// <param name="btn">button to test</param>
+/// <param name="touch_state">touch points of the scan</param>
+/// <returns>true if the button is touched</returns>
+static bool hit(const button_t* btn, const TS_MultiTouch_State_t* touch_state) {
+    const uint32_t left = btn->x; //The touch coordinates are unsigned
+    const uint32_t top = btn->y;
+    for (uint32_t i = 0; i < touch_state->TouchDetected; ++i) {
+        if (left <= touch_state->TouchX[i] && left + X_BTN >= touch_state->TouchX[i] &&
+            top <= touch_state->TouchY[i] && top + Y_BTN >= touch_state->TouchY[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// <summary>
+/// Emits an action of a gesture
+/// </summary>
+/// <param name="action">to emit</param>
+/// <param name="timestamp">of the report that completed the gesture</param>
+static void emit_gesture(action_t action, uint32_t timestamp) {
+    const input_event_t event = { action, INPUT_PRESS, timestamp, INPUT_SOURCE_GESTURE };
+    ++input_stats.actions;
+    if (emit) {
+        emit(&event);
+    }
+}
+
+/// <summary>
+/// Follows a touch on the playing field, the controller recognizes the swipes itself so only its gesture id is read.
+/// A touch that ends without a gesture close to where it started is a tap, gestures without an action and touches
+/// that moved farther are dropped
+/// </summary>
+/// <param name="touch_state">touch points of the scan</param>
+/// <param name="timestamp">of the scanned report</param>
+static void scan_gesture(const TS_MultiTouch_State_t* touch_state, uint32_t timestamp) {
+    if (!gesture_active) {
+        if (touch_state->TouchDetected == 0 ||
+            touch_state->TouchX[0] < X_GESTURE_START || touch_state->TouchX[0] >= X_GESTURE_END) {
+            return;
+        }
+        gesture_active = true;
+        gesture_done = false;
+        gesture_moved = false;
+        gesture_start = timestamp;
+        gesture_x = touch_state->TouchX[0];
+        gesture_y = touch_state->TouchY[0];
+    }
+
+    if (touch_state->TouchDetected != 0 &&
+        (abs((int32_t)touch_state->TouchX[0] - gesture_x) > INPUT_TAP_TRAVEL ||
+        abs((int32_t)touch_state->TouchY[0] - gesture_y) > INPUT_TAP_TRAVEL)) {
+        gesture_moved = true;
+    }
+
+    if (!gesture_done) {
+        uint32_t id = GESTURE_ID_NO_GESTURE;
+        BSP_TS_GetGestureId(0, &id);
+        if (id < GESTURE_ID_NB_MAX && gesture_actions[id] >= 0) {
+            gesture_done = true;
+            input_stats.gesture_us = (timestamp - gesture_start) / CYCLES_PER_US;
+            ++input_stats.swipes;
+            emit_gesture((action_t)gesture_actions[id], timestamp);
+        } else if (id != GESTURE_ID_NO_GESTURE) {
+            gesture_done = true;
+            ++input_stats.dropped;
+        }
+    }
+
+    if (touch_state->TouchDetected == 0) {
+        if (!gesture_done && gesture_moved) {
+            ++input_stats.dropped;
+        } else if (!gesture_done) {
+            ++input_stats.taps;
+            emit_gesture(ROTATE_RIGHT, timestamp);
+        }
+        gesture_active = false;
+    }
+}
+
+/// <summary>
+/// Reads all touch points, updates the button states and emits a press or a release for every button whose state changed
+/// </summary>
+/// <param name=""></param>
+void input_scan(void) {
+    TS_MultiTouch_State_t touch_state;
+
+    LOCK();
+    const uint32_t timestamp = pending ? pending_timestamp : DWT->CYCCNT;
+    pending = false;
+    UNLOCK();
+
+    BSP_TS_Get_MultiTouchState(0, &touch_state);
+    ++input_stats.scans;
+    touch_state.TouchDetected = MIN(touch_state.TouchDetected, TS_TOUCH_NBR);
+    touching = touch_state.TouchDetected != 0;
+    input_stats.max_touches = MAX(input_stats.max_touches, touch_state.TouchDetected);
+
+    for (size_t i = 0; i < N_BTN; ++i) {
+        buttons[i].state = (buttons[i].state << 1) | hit(&buttons[i], &touch_state);
+        //Every report is already filtered by the controller, so the first one inside the button is a press
+        const input_repeat_t* config = &repeat_config[buttons[i].action];
+        input_event_t event = { buttons[i].action, INPUT_PRESS, timestamp, INPUT_SOURCE_BUTTON };
+        switch (buttons[i].state & 0x3) {
+            case 0x1:
+                buttons[i].polygon.selected = 1 - buttons[i].polygon.selected;
+                repeat_armed[i] = config->delay_us != 0;
+                repeat_deadline[i] = timestamp + config->delay_us * CYCLES_PER_US;
+                ++input_stats.actions;
+                break;
+            case 0x2:
+                event.type = INPUT_RELEASE;
+                repeat_armed[i] = false;
+                ++input_stats.releases;
+                break;
+            default:
+                continue;
+        }
+        if (emit) {
+            emit(&event);
+        }
+    }
+
+    if (mode == INPUT_MODE_GESTURES) {
+        scan_gesture(&touch_state, timestamp);
+    }
+}
+
+/// <summary>
+/// Emits the repeats of the held buttons that are due in the order they were due, every repeat is stamped with the
+/// time it was due so late polling does not shift the repeat grid. A held play/pause switches the controls instead, its
+/// press already paused the game
+/// </summary>
+/// <param name="now">cycle counter</param>
+void input_repeat(uint32_t now) {
+    uint32_t deadline = 0;
+    while (next_deadline(&deadline) && (int32_t)(now - deadline) >= 0) {
+        for (size_t i = 0; i < N_BTN; ++i) {
+            if (repeat_armed[i] && repeat_deadline[i] == deadline) {
+                const input_repeat_t* config = &repeat_config[buttons[i].action];
+                const input_event_t event = { buttons[i].action, INPUT_REPEAT, deadline, INPUT_SOURCE_BUTTON };
+                repeat_armed[i] = config->period_us != 0;
+                repeat_deadline[i] += config->period_us * CYCLES_PER_US;
+                if (buttons[i].action == PLAY_PAUSE) {
+                    input_set_mode((mode == INPUT_MODE_BUTTONS) ? INPUT_MODE_GESTURES : INPUT_MODE_BUTTONS);
+                    ++input_stats.mode_switches;
+                    continue;
+                }
+                ++input_stats.repeats;
+                if (emit) {
+                    emit(&event);
+                }
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Sets the delayed auto shift and the auto repeat rate of an action, takes effect with the next press
+/// </summary>
+/// <param name="action">to configure</param>
+/// <param name="delay_us">hold time before the first repeat, 0 disables repeating</param>
+/// <param name="period_us">time between the following repeats, 0 repeats only once</param>
+void input_set_repeat(action_t action, uint32_t delay_us, uint32_t period_us) {
+    if (action < N_ACTIONS) {
+        repeat_config[action] = (input_repeat_t){ delay_us, period_us };
+    }
+}
+
+/// <summary>
+/// Selects the controls
+/// </summary>
+/// <param name="input_mode">buttons only or gestures and buttons</param>
+void input_set_mode(input_mode_t input_mode) {
+    mode = input_mode;
+    gesture_active = false;
+}
+
+/// <summary>
+/// Gets the selected controls
+/// </summary>
+/// <param name=""></param>
+/// <returns>input mode</returns>
+input_mode_t input_get_mode(void) {
+    return mode;
+}
+
+/// <summary>
+/// Checks if the last scan found the panel touched
+/// </summary>
+/// <param name=""></param>
+/// <returns>true while a finger is on the panel</returns>
+bool input_touching(void) {
+    return touching;
+}
+
+/// <summary>
+/// Gets the current time in the units of the event timestamps
+/// </summary>
+/// <param name=""></param>
+/// <returns>cycle counter</returns>
+uint32_t input_timestamp(void) {
+    return DWT->CYCCNT;
+}
+
+/// <summary>
+/// Records the latency from the touch to the moment its action was performed
+/// </summary>
+/// <param name="event">that was performed</param>
+void input_performed(const input_event_t* event) {
+    input_latency_t* stats = &input_stats.latency[event->source % N_INPUT_SOURCES];
+    const uint32_t latency = (DWT->CYCCNT - event->timestamp) / CYCLES_PER_US;
+    stats->last_us = latency;
+    stats->max_us = MAX(stats->max_us, latency);
+    stats->total_us += latency;
+    ++stats->count;
+}
+
+/// <summary>
+/// Gets the average latency from the touch to the performed action
+/// </summary>
+/// <param name="source">buttons or gestures</param>
+/// <returns>latency in microseconds</returns>
+uint32_t input_average_latency_us(input_source_t source) {
+    const input_latency_t* stats = &input_stats.latency[source % N_INPUT_SOURCES];
+    return stats->count ? stats->total_us / stats->count : 0;
+}
+
+#if defined(USE_HAL_DRIVER)
+/// <summary>
+/// Called by the BSP from the EXTI interrupt of the touch controller
+/// </summary>
+/// <param name="Instance">of the touch screen</param>
+void BSP_TS_Callback(uint32_t Instance) {
+    input_touch_irq();
+}
+#endif // USE_HAL_DRIVER
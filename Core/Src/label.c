@@ -0,0 +1,99 @@
+/*
+ * label.c
+ */
+#include "label.h"
+#include "main.h"
+
+/// <summary>
+/// Computes the left edge of the text the same way UTIL_LCD_DisplayStringAt does
+/// </summary>
+/// <param name="label">rasterized label</param>
+/// <param name="length">number of characters</param>
+/// <returns>left edge in pixels</returns>
+static uint16_t align(const label_t* label, uint32_t length) {
+    const sFONT* font = UTIL_LCD_GetFont();
+    uint32_t x_size;
+    BSP_LCD_GetXSize(0, &x_size);
+    const uint32_t columns = x_size / font->Width;
+    uint32_t left;
+    switch (label->mode) {
+        case CENTER_MODE:
+            left = label->x + ((columns - length) * font->Width) / 2;
+            break;
+        case RIGHT_MODE:
+            left = -(uint32_t)label->x + ((columns - length) * font->Width);
+            break;
+        case LEFT_MODE:
+        default:
+            left = label->x;
+            break;
+    }
+    return (left < 1 || left >= 0x8000) ? 1 : left;
+}
+
+/// <summary>
+/// Formats the values and rasterizes the text into the bitmap if they differ from the current ones
+/// </summary>
+/// <param name="label">to be updated</param>
+/// <param name="a">first value of the format</param>
+/// <param name="b">second value of the format</param>
+/// <returns>true if the label was rasterized again</returns>
+bool label_update(label_t* label, long a, long b) {
+    if (label->version != 0 && label->values[0] == a && label->values[1] == b) {
+        return false;
+    }
+    label->values[0] = a;
+    label->values[1] = b;
+    snprintf(label->text, LABEL_TEXT_SIZE, label->format, a, b);
+
+    const uint32_t length = strlen(label->text);
+    label->width = UTIL_LCD_RasterizeString(label->bitmap, label->capacity, (uint8_t*)label->text);
+    label->rasterized = label->width != 0 || length == 0;
+    if (!label->rasterized) {
+        label->width = length * UTIL_LCD_GetFont()->Width;
+    }
+    label->height = UTIL_LCD_GetFont()->Height;
+    label->left = align(label, length);
+    ++label->version;
+    ++label->rasterizations;
+    return true;
+}
+
+/// <summary>
+/// Blits the label unless the buffer already holds its current bitmap
+/// </summary>
+/// <param name="label">to be drawn</param>
+/// <param name="previous">what the buffer holds of the label, NULL if the buffer is empty</param>
+void label_draw(const label_t* label, const label_state_t* previous) {
+    if (previous != NULL) {
+        if (previous->version == label->version) {
+            return;
+        }
+        //Clear the parts of the previous text that the new one does not cover
+        const uint32_t right = label->left + label->width;
+        const uint32_t previous_right = previous->left + previous->width;
+        const uint32_t back_color = UTIL_LCD_GetBackColor();
+        if (previous->left < label->left) {
+            UTIL_LCD_FillRect(previous->left, label->y, MIN(previous_right, label->left) - previous->left, label->height, back_color);
+        }
+        if (previous_right > right) {
+            const uint32_t start = MAX(previous->left, right);
+            UTIL_LCD_FillRect(start, label->y, previous_right - start, label->height, back_color);
+        }
+    }
+    if (!label->rasterized) {
+        UTIL_LCD_DisplayStringAt(label->x, label->y, (uint8_t*)label->text, label->mode);
+    } else if (label->width != 0) {
+        UTIL_LCD_FillRGBRect(label->left, label->y, label->bitmap, label->width, label->height);
+    }
+}
+
+/// <summary>
+/// Gets what a buffer holds after the label is drawn into it
+/// </summary>
+/// <param name="label">drawn label</param>
+/// <returns>state of the label in the buffer</returns>
+label_state_t label_state(const label_t* label) {
+    const label_state_t state = { label->version, label->left, label->width };
+    return state;
+}
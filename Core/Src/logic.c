@@ -0,0 +1,129 @@
+/*
+ * logic.c
+ */
+#include "logic.h"
+#include "main.h"
+
+#if defined(USE_HAL_DRIVER)
+#include "cmsis_os.h"
+
+#define CYCLES_PER_US (SystemCoreClock / 1000000U)
+#define LOCK() NVIC_DisableIRQ(TIM2_IRQn)
+#define UNLOCK() NVIC_EnableIRQ(TIM2_IRQn)
+#else
+#define CYCLES_PER_US 1000U //The host cycle counter counts nanoseconds
+#define LOCK()
+#define UNLOCK()
+#endif // USE_HAL_DRIVER
+
+#define SLOT_MASK 0x3U
+#define SLOT_FRESH 0x4U //The middle slot holds a snapshot the renderer has not taken yet
+
+static void* volatile task = NULL;
+static volatile uint32_t tick_timestamp = 0; //Cycle counter at the last tick
+
+//Triple buffer: the logic task fills the back slot and swaps it with the middle one, the renderer swaps the middle
+//slot with its front slot when it is fresh, neither side waits and a published snapshot is never written again
+static snapshot_t slots[3];
+static uint32_t back_slot = 0;
+static _Atomic uint32_t middle_slot = 1;
+static uint32_t front_slot = 2;
+static uint32_t sequence = 0;
+
+logic_stats_t logic_stats = { 0 };
+
+/// <summary>
+/// Publishes the current state of the game, the calling task is the one woken up by the tick timer
+/// </summary>
+/// <param name=""></param>
+void logic_init(void) {
+#if defined(USE_HAL_DRIVER)
+    task = osThreadGetId();
+#endif // USE_HAL_DRIVER
+    take_snapshot(&slots[front_slot]);
+    slots[front_slot].sequence = sequence;
+}
+
+/// <summary>
+/// Records the time of the tick and wakes up the logic task, called from the interrupt of the tick timer
+/// </summary>
+/// <param name=""></param>
+void logic_tick_irq(void) {
+    tick_timestamp = DWT->CYCCNT;
+    ++logic_stats.ticks;
+#if defined(USE_HAL_DRIVER)
+    if (task) {
+        osThreadFlagsSet((osThreadId_t)task, LOGIC_TICK_FLAG);
+    }
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Blocks the logic task until the next tick, returns at once if a tick is already pending
+/// </summary>
+/// <param name=""></param>
+void logic_wait(void) {
+#if defined(USE_HAL_DRIVER)
+    osThreadFlagsWait(LOGIC_TICK_FLAG, osFlagsWaitAny, osWaitForever);
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Performs the queued actions, simulates every pending tick and publishes a snapshot of the result
+/// </summary>
+/// <param name="rings">of actions, drained oldest first</param>
+/// <param name="count">number of rings</param>
+void logic_step(action_ring_t* const rings[], size_t count) {
+    const uint32_t start = DWT->CYCCNT;
+    LOCK();
+    const uint32_t ticks = logic_stats.ticks;
+    const uint32_t timestamp = tick_timestamp;
+    UNLOCK();
+
+    //Ticks that were missed while the step was delayed are simulated now, each one a period later than the previous
+    const uint32_t pending = ticks - logic_stats.steps;
+    if (pending != 0) {
+        const uint32_t jitter_us = (start - timestamp) / CYCLES_PER_US + (pending - 1) * LOGIC_PERIOD_US;
+        logic_stats.max_jitter_us = MAX(logic_stats.max_jitter_us, jitter_us);
+        if (jitter_us > LOGIC_JITTER_LIMIT_US) {
+            ++logic_stats.late;
+        }
+    }
+
+    input_event_t event;
+    while (action_ring_pop_oldest(rings, count, &event)) {
+        if (event.type != INPUT_RELEASE) {
+            perform_action(event.action);
+            input_performed(&event);
+        }
+    }
+    for (uint32_t i = 0; i < pending; ++i) {
+        tick();
+        update_state();
+        clear_lines();
+    }
+    logic_stats.steps = ticks;
+
+    snapshot_t* snapshot = &slots[back_slot];
+    take_snapshot(snapshot);
+    snapshot->sequence = ++sequence;
+    back_slot = atomic_exchange(&middle_slot, back_slot | SLOT_FRESH) & SLOT_MASK;
+    ++logic_stats.published;
+
+    logic_stats.max_step_us = MAX(logic_stats.max_step_us, (DWT->CYCCNT - start) / CYCLES_PER_US);
+}
+
+/// <summary>
+/// Gets the latest published snapshot, called only by the renderer
+/// </summary>
+/// <param name=""></param>
+/// <returns>snapshot that stays unchanged until the next call</returns>
+const snapshot_t* logic_snapshot(void) {
+    if (atomic_load(&middle_slot) & SLOT_FRESH) {
+        const uint32_t previous = slots[front_slot].sequence;
+        front_slot = atomic_exchange(&middle_slot, front_slot) & SLOT_MASK;
+        ++logic_stats.rendered;
+        logic_stats.skipped += slots[front_slot].sequence - previous - 1;
+    }
+    return &slots[front_slot];
+}
@@ -51,8 +51,13 @@ osThreadId_t inputTaskHandle;
 const osThreadAttr_t inputTask_attributes = { .name = "inputTask", .stack_size =
         128 * 4, .priority = (osPriority_t)osPriorityLow, };
 /* USER CODE BEGIN PV */
-osMessageQueueId_t actionQueue;
+osThreadId_t logicTaskHandle;
+const osThreadAttr_t logicTask_attributes = { .name = "logicTask", .stack_size =
+        256 * 4, .priority = (osPriority_t)osPriorityHigh, };
+action_ring_t input_ring; //Produced by the input task
+action_ring_t button_ring; //Produced by the user button interrupt
 TIM_HandleTypeDef tim2;
+TIM_HandleTypeDef tim5;
 RNG_HandleTypeDef rng;
 /* USER CODE END PV */
 
@@ -62,12 +67,15 @@ void StartLcdTask(void* argument);
 void StartInputTask(void* argument);
 
 /* USER CODE BEGIN PFP */
+static void DWT_Config(void);
 static void LCD_Config(void);
 static void TS_Config(void);
 static void TIM_Config(void);
 static void BTN_Config(void);
 static void RNG_Config(void);
 static void MMC_Config(void);
+static void queue_input_event(const input_event_t* event);
+static void StartLogicTask(void* argument);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -99,6 +107,7 @@ int main(void) {
     /* USER CODE BEGIN SysInit */
     TS_Config();
     RNG_Config();
+    DWT_Config();
     LCD_Config();
     TIM_Config();
     BTN_Config();
@@ -126,7 +135,8 @@ int main(void) {
     /* USER CODE END RTOS_TIMERS */
 
     /* USER CODE BEGIN RTOS_QUEUES */
-    actionQueue = osMessageQueueNew(32, sizeof(action_t), NULL);
+    action_ring_init(&input_ring);
+    action_ring_init(&button_ring);
     /* USER CODE END RTOS_QUEUES */
 
     /* Create the thread(s) */
@@ -138,6 +148,7 @@ int main(void) {
 
     /* USER CODE BEGIN RTOS_THREADS */
     /* add threads, ... */
+    logicTaskHandle = osThreadNew(StartLogicTask, NULL, &logicTask_attributes);
     /* USER CODE END RTOS_THREADS */
 
     /* USER CODE BEGIN RTOS_EVENTS */
@@ -234,13 +245,34 @@ void SystemClock_Config(void) {
 }
 
 /* USER CODE BEGIN 4 */
+static void DWT_Config(void) {
+    //The cycle counter is used to measure the rendering
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 static void LCD_Config(void) {
-    BSP_LCD_Init(0, LCD_ORIENTATION_LANDSCAPE);
-    BSP_LCD_SetLayerAddress(0, 0, LCD_LAYER_0_ADDRESS);
+    BSP_LCD_InitEx(0, LCD_ORIENTATION_LANDSCAPE, LCD_FRAME_FORMAT, LCD_DEFAULT_WIDTH, LCD_DEFAULT_HEIGHT);
+    dma2d_queue_init();
+    //The static background is under the frame buffers, the LTDC blends them on every refresh
+    BSP_LCD_SetLayerAddress(0, BACKGROUND_LAYER, LCD_BACKGROUND_ADDRESS);
+    BSP_LCD_LayerConfig_t foreground = { 0, LCD_DEFAULT_WIDTH, 0, LCD_DEFAULT_HEIGHT, LCD_FRAME_FORMAT, LCD_LAYER_0_ADDRESS };
+    BSP_LCD_ConfigLayer(0, FOREGROUND_LAYER, &foreground);
+    BSP_LCD_SetColorKeying(0, FOREGROUND_LAYER, TRANSPARENT_COLOR & 0x00FFFFFFU); //The key has no alpha
+    palette_init();
     UTIL_LCD_SetFuncDriver(&LCD_Driver);
+    UTIL_LCD_SetLayer(BACKGROUND_LAYER);
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_SetLayer(FOREGROUND_LAYER);
+    UTIL_LCD_SetGlyphCache((uint8_t*)LCD_GLYPH_CACHE_ADDRESS, LCD_GLYPH_CACHE_SIZE, dma2d_sync);
     UTIL_LCD_SetFont(&Font12);
     UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_BLACK);
     UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);
+    //The glyph cache, the labels and the sprites follow each other and are blitted without staging
+    dma2d_retain(LCD_GLYPH_CACHE_ADDRESS, LCD_SPRITE_ADDRESS + LCD_SPRITE_SIZE - LCD_GLYPH_CACHE_ADDRESS);
+    sprite_atlas_init((uint8_t*)LCD_SPRITE_ADDRESS, LCD_SPRITE_SIZE);
+    init_sprites();
     UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
     HAL_NVIC_SetPriority(LTDC_IRQn, 10, 10);
     HAL_NVIC_EnableIRQ(LTDC_IRQn);
@@ -249,6 +281,12 @@ static void LCD_Config(void) {
 static void TS_Config(void) {
     TS_Init_t init = { TS_MAX_WIDTH, TS_MAX_HEIGHT, TS_SWAP_XY, 5 };
     BSP_TS_Init(0, &init);
+    //Swipe recognition of the controller, used by the gesture controls
+    TS_Gesture_Config_t gesture = { .Radian = 0x0A, .OffsetLeftRight = 0x28, .OffsetUpDown = 0x28,
+        .DistanceLeftRight = 0x19, .DistanceUpDown = 0x19, .DistanceZoom = 0x32 };
+    BSP_TS_GestureConfig(0, &gesture);
+    TS_INT_GPIO_CLK_ENABLE();
+    BSP_TS_EnableIT(0); //The input task only reads the controller after it signals a touch report
 }
 
 static void TIM_Config(void) {
@@ -263,6 +301,19 @@ static void TIM_Config(void) {
     tim2.Init.Prescaler = 200 - 1;
     HAL_TIM_Base_Init(&tim2);
     __HAL_TIM_CLEAR_FLAG(&tim2, TIM_FLAG_UPDATE);
+
+    //Repeats of held buttons, one pulse timer counting microseconds that is started by the input task
+    __HAL_RCC_TIM5_CLK_ENABLE();
+    HAL_NVIC_SetPriority(TIM5_IRQn, 10, 10);
+    HAL_NVIC_EnableIRQ(TIM5_IRQn);
+    tim5.Instance = TIM5;
+    tim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+    tim5.Init.Period = 0xffffffff;
+    tim5.Init.Prescaler = 200 - 1;
+    HAL_TIM_Base_Init(&tim5);
+    tim5.Instance->CR1 |= TIM_CR1_OPM;
+    __HAL_TIM_CLEAR_FLAG(&tim5, TIM_FLAG_UPDATE);
+    __HAL_TIM_ENABLE_IT(&tim5, TIM_IT_UPDATE);
 }
 
 static void BTN_Config(void) {
@@ -292,14 +343,27 @@ static void MMC_Config(void) {
     int32_t mmc_state = BSP_MMC_Init(0);
 }
 
-void HAL_LTDC_ReloadEventCallback(LTDC_HandleTypeDef* hltdc) {
-    static uint16_t buffer_index = 0;
+void HAL_LTDC_LineEventCallback(LTDC_HandleTypeDef* hltdc) {
+    swapchain_blanking_irq();
+}
+
+static void queue_input_event(const input_event_t* event) {
+    action_ring_push(&input_ring, event);
+}
 
-    buffer_index = 1 - buffer_index;
-    uint32_t buffer_addr = (buffer_index) ? LCD_LAYER_1_ADDRESS : LCD_LAYER_0_ADDRESS;
-    BSP_LCD_Reload(0, BSP_LCD_RELOAD_NONE); //Disable reloading
-    BSP_LCD_SetLayerAddress(0, 0, buffer_addr); //Update the buffer
-    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK); //Clear the new buffer
+/**
+ * @brief Function implementing the logicTask thread, simulates the game on every tick of TIM2
+ *        at a priority above the lcd task, so that slow frames do not slow down the game
+ * @param argument: Not used
+ * @retval None
+ */
+static void StartLogicTask(void* argument) {
+    action_ring_t* const rings[] = { &input_ring, &button_ring };
+    logic_init();
+    for (;;) {
+        logic_wait();
+        logic_step(rings, 2);
+    }
 }
 
 /* USER CODE END 4 */
@@ -314,16 +378,16 @@ void HAL_LTDC_ReloadEventCallback(LTDC_HandleTypeDef* hltdc) {
 void StartLcdTask(void* argument) {
     /* USER CODE BEGIN 5 */
     /* Infinite loop */
-    action_t action;
+    vsync_init();
+    swapchain_init();
     for (;;) {
-        while (osMessageQueueGet(actionQueue, &action, 0U, 0U) == osOK) {
-            perform_action(action);
-        }
-        update_state();
-        clear_lines();
-        render();
-        BSP_LCD_Reload(0, BSP_LCD_RELOAD_VERTICAL_BLANKING);
-        osDelay(20);
+        swapchain_wait(); //Starts at most one frame per refresh, at once if the previous frame took longer
+        const uint32_t buffer = swapchain_acquire();
+        const snapshot_t* snapshot = logic_snapshot();
+        render(buffer, snapshot);
+        dma2d_fence(); //The frame has to be complete before it is presented
+        swapchain_present(buffer);
+        vsync_present(snapshot->sequence);
     }
     /* USER CODE END 5 */
 }
@@ -336,32 +400,14 @@ void StartLcdTask(void* argument) {
  */
  /* USER CODE END Header_StartInputTask */
 void StartInputTask(void* argument) {
-    TS_State_t touch_state;
     /* USER CODE BEGIN StartInputTask */
+    input_init(queue_input_event);
     /* Infinite loop */
     for (;;) {
-        BSP_TS_GetState(0, &touch_state);
-        //Shift button state
-        for (size_t i = 0; i < N_BTN; ++i) {
-            buttons[i].state <<= 1;
-        }
-        //Get new button states
-        if (touch_state.TouchDetected) {
-            for (size_t i = 0; i < N_BTN; ++i) {
-                buttons[i].state |= (buttons[i].x <= touch_state.TouchX &&
-                    buttons[i].x + X_BTN >= touch_state.TouchX &&
-                    buttons[i].y <= touch_state.TouchY &&
-                    buttons[i].y + Y_BTN >= touch_state.TouchY);
-            }
-        }
-        //Update actions
-        for (size_t i = 0; i < N_BTN; ++i) {
-            if ((buttons[i].state & 0xf) == 0x3) {
-                buttons[i].polygon.selected = 1 - buttons[i].polygon.selected;
-                osMessageQueuePut(actionQueue, &buttons[i].action, 2U, 0U);
-            }
+        if (input_wait()) {
+            input_scan();
         }
-        osDelay(10);
+        input_repeat(input_timestamp());
     }
     /* USER CODE END StartInputTask */
 }
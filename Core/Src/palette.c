@@ -0,0 +1,80 @@
+/*
+ * palette.c
+ */
+#include "palette.h"
+#include "main.h"
+
+static uint32_t palette[PALETTE_SIZE]; //Colors the game draws with, their index is what an L8 pixel stores
+static uint32_t clut[PALETTE_SIZE]; //Colors the indices are displayed in
+static volatile bool clut_changed = false;
+
+/// <summary>
+/// Builds the palette from colors[] and loads it into the CLUT of both layers
+/// </summary>
+/// <param name=""></param>
+void palette_init(void) {
+    //Index 0 is the transparent color, colors missing from the palette are drawn as it
+    const uint32_t hud[] = { TRANSPARENT_COLOR, UTIL_LCD_COLOR_WHITE, UTIL_LCD_COLOR_GRAY, UTIL_LCD_COLOR_LIGHTGRAY };
+    memcpy(palette, hud, sizeof(hud));
+    memcpy(&palette[sizeof(hud) / sizeof(hud[0])], colors, sizeof(colors));
+    memcpy(clut, palette, sizeof(clut));
+    clut_changed = false;
+    UTIL_LCD_SetPalette(palette, PALETTE_SIZE);
+#if defined(USE_HAL_DRIVER)
+    if (LCD_FRAME_FORMAT == LCD_PIXEL_FORMAT_L8) {
+        HAL_LTDC_ConfigCLUT(&hlcd_ltdc, clut, PALETTE_SIZE, BACKGROUND_LAYER);
+        HAL_LTDC_EnableCLUT(&hlcd_ltdc, BACKGROUND_LAYER);
+        HAL_LTDC_ConfigCLUT(&hlcd_ltdc, clut, PALETTE_SIZE, FOREGROUND_LAYER);
+        HAL_LTDC_EnableCLUT(&hlcd_ltdc, FOREGROUND_LAYER);
+    }
+#else
+    host_lcd_set_clut(clut, PALETTE_SIZE);
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Changes the color an index is displayed in from the next frame on, without drawing anything. Drawing still uses
+/// the color the palette was built with
+/// </summary>
+/// <param name="index">of the color in the palette</param>
+/// <param name="color">to display the index in</param>
+void palette_set(uint8_t index, uint32_t color) {
+    if (index < PALETTE_SIZE) {
+        clut[index] = color;
+        clut_changed = true;
+    }
+}
+
+/// <summary>
+/// Finds the index a color of the game is drawn with
+/// </summary>
+/// <param name="color">ARGB8888 color</param>
+/// <returns>index of the color, 0 if it is not in the palette</returns>
+uint8_t palette_index(uint32_t color) {
+    for (uint8_t i = 0; i < PALETTE_SIZE; ++i) {
+        if (palette[i] == color) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/// <summary>
+/// Writes the changed colors into the CLUT, called from the blanking interrupt while the display is blanked
+/// </summary>
+/// <param name=""></param>
+void palette_reload_irq(void) {
+    if (!clut_changed) {
+        return;
+    }
+    clut_changed = false;
+#if defined(USE_HAL_DRIVER)
+    for (uint32_t i = 0; i < PALETTE_SIZE; ++i) {
+        const uint32_t entry = (i << LTDC_LxCLUTWR_CLUTADD_Pos) | (clut[i] & 0x00FFFFFFU);
+        LTDC_LAYER(&hlcd_ltdc, BACKGROUND_LAYER)->CLUTWR = entry;
+        LTDC_LAYER(&hlcd_ltdc, FOREGROUND_LAYER)->CLUTWR = entry;
+    }
+#else
+    host_lcd_set_clut(clut, PALETTE_SIZE);
+#endif // USE_HAL_DRIVER
+}
@@ -0,0 +1,71 @@
+/*
+ * sprites.c
+ */
+#include "sprites.h"
+#include "main.h"
+
+static uint8_t* atlas;
+static uint32_t atlas_size;
+static uint32_t atlas_used;
+
+/// <summary>
+/// Sets the memory the captured sprites are stored in
+/// </summary>
+/// <param name="memory">of the atlas</param>
+/// <param name="size">of the atlas in bytes</param>
+void sprite_atlas_init(uint8_t* memory, uint32_t size) {
+    atlas = memory;
+    atlas_size = size;
+    atlas_used = 0;
+}
+
+/// <summary>
+/// Copies a rectangle of the frame buffer into the atlas
+/// </summary>
+/// <param name="sprite">where the captured sprite is stored</param>
+/// <param name="x">position of the rectangle</param>
+/// <param name="y">position of the rectangle</param>
+/// <param name="width">of the rectangle</param>
+/// <param name="height">of the rectangle</param>
+/// <returns>false if the atlas is full</returns>
+bool sprite_capture(sprite_t* sprite, uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    uint32_t format;
+    BSP_LCD_GetPixelFormat(0, &format);
+    const uint32_t bpp = (format == LCD_PIXEL_FORMAT_RGB565) ? 2 : (format == LCD_PIXEL_FORMAT_L8) ? 1 : 4;
+    const uint32_t size = width * height * bpp;
+    if (atlas_used + size > atlas_size) {
+        return false;
+    }
+
+    sprite->pixels = atlas + atlas_used;
+    sprite->width = width;
+    sprite->height = height;
+    atlas_used += size;
+
+    //Pixels are read in the frame buffer format so that the sprite can be blitted without conversion
+    uint8_t* pixel = sprite->pixels;
+    for (uint16_t i = 0; i < height; ++i) {
+        for (uint16_t j = 0; j < width; ++j, pixel += bpp) {
+            uint32_t color;
+            BSP_LCD_ReadPixel(0, x + j, y + i, &color);
+            if (bpp == 1) {
+                *pixel = (uint8_t)color;
+            } else if (bpp == 2) {
+                *(uint16_t*)pixel = (uint16_t)color;
+            } else {
+                *(uint32_t*)pixel = color;
+            }
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Blits the sprite with a single transfer
+/// </summary>
+/// <param name="sprite">to be drawn</param>
+/// <param name="x">position of the sprite</param>
+/// <param name="y">position of the sprite</param>
+void sprite_draw(const sprite_t* sprite, uint16_t x, uint16_t y) {
+    UTIL_LCD_FillRGBRect(x, y, sprite->pixels, sprite->width, sprite->height);
+}
@@ -62,7 +62,8 @@
 
 /* USER CODE BEGIN EV */
 extern TIM_HandleTypeDef tim2;
-extern osMessageQueueId_t actionQueue;
+extern TIM_HandleTypeDef tim5;
+extern action_ring_t button_ring;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -179,19 +180,37 @@ void LTDC_IRQHandler(void) {
     HAL_NVIC_ClearPendingIRQ(LTDC_IRQn);
 }
 
+void DMA2D_IRQHandler(void) {
+    dma2d_irq_handler();
+    HAL_NVIC_ClearPendingIRQ(DMA2D_IRQn);
+}
+
 void TIM2_IRQHandler(void) {
     if (__HAL_TIM_GET_FLAG(&tim2, TIM_FLAG_UPDATE)) {
-        tick();
+        logic_tick_irq();
         __HAL_TIM_CLEAR_FLAG(&tim2, TIM_FLAG_UPDATE);
     }
     HAL_NVIC_ClearPendingIRQ(TIM2_IRQn);
 }
 
+void TIM5_IRQHandler(void) {
+    if (__HAL_TIM_GET_FLAG(&tim5, TIM_FLAG_UPDATE)) {
+        __HAL_TIM_CLEAR_FLAG(&tim5, TIM_FLAG_UPDATE);
+        input_repeat_irq();
+    }
+    HAL_NVIC_ClearPendingIRQ(TIM5_IRQn);
+}
+
+void EXTI2_IRQHandler(void) {
+    BSP_TS_IRQHandler(0);
+    HAL_NVIC_ClearPendingIRQ(EXTI2_IRQn);
+}
+
 void EXTI15_10_IRQHandler(void) {
-    static const action_t reset = RESET_GAME;
     if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_13)) {
+        const input_event_t reset = { RESET_GAME, INPUT_PRESS, input_timestamp(), INPUT_SOURCE_BUTTON };
         __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_13);
-        osMessageQueuePut(actionQueue, &reset, 0U, 0U);
+        action_ring_push(&button_ring, &reset);
         HAL_NVIC_ClearPendingIRQ(EXTI15_10_IRQn);
     }
 }
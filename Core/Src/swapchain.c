@@ -0,0 +1,161 @@
+/*
+ * swapchain.c
+ */
+#include "swapchain.h"
+#include "main.h"
+
+#if defined(USE_HAL_DRIVER)
+#include "cmsis_os.h"
+
+#define LOCK() NVIC_DisableIRQ(LTDC_IRQn)
+#define UNLOCK() NVIC_EnableIRQ(LTDC_IRQn)
+
+static const uint32_t buffer_addresses[] = { LCD_LAYER_0_ADDRESS, LCD_LAYER_1_ADDRESS, LCD_LAYER_2_ADDRESS };
+#else
+#define LOCK()
+#define UNLOCK()
+#endif // USE_HAL_DRIVER
+
+#define NO_BUFFER N_FRAME_BUFFERS
+
+//The screen, the latest presented frame and the renderer each own at most one buffer, so a free one is always left
+_Static_assert(N_FRAME_BUFFERS == 3, "the mailbox needs a buffer for the screen, the ready frame and the renderer");
+
+//Every buffer is owned by exactly one side: the renderer draws only into the buffer it acquired and the display only
+//reads the ready and the scanned out buffers, the blanking interrupt hands them back
+static volatile swap_state_t states[N_FRAME_BUFFERS];
+static void* volatile task = NULL;
+
+swapchain_stats_t swapchain_stats = { 0 };
+
+/// <summary>
+/// Finds a buffer in the given state
+/// </summary>
+/// <param name="state">to look for</param>
+/// <returns>index of the buffer, NO_BUFFER if there is none</returns>
+static uint32_t find(swap_state_t state) {
+    for (uint32_t i = 0; i < N_FRAME_BUFFERS; ++i) {
+        if (states[i] == state) {
+            return i;
+        }
+    }
+    return NO_BUFFER;
+}
+
+#if defined(USE_HAL_DRIVER)
+/// <summary>
+/// Raises the line interrupt at the first line after the active area, once per refresh
+/// </summary>
+/// <param name=""></param>
+static void arm_blanking(void) {
+    LTDC->LIPCR = (LTDC->AWCR & LTDC_AWCR_AAH) + 1;
+    __HAL_LTDC_ENABLE_IT(&hlcd_ltdc, LTDC_IT_LI);
+}
+#endif // USE_HAL_DRIVER
+
+/// <summary>
+/// Hands every buffer except the one on the screen to the renderer, the calling task is the one woken up by the
+/// vertical blanking
+/// </summary>
+/// <param name=""></param>
+void swapchain_init(void) {
+#if defined(USE_HAL_DRIVER)
+    task = osThreadGetId();
+#endif // USE_HAL_DRIVER
+    states[0] = SWAP_SCANOUT; //The layer shows the first buffer since the LCD was configured
+    for (uint32_t i = 1; i < N_FRAME_BUFFERS; ++i) {
+        states[i] = SWAP_FREE;
+    }
+#if defined(USE_HAL_DRIVER)
+    arm_blanking();
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Takes a buffer for drawing and directs the drawing into it, never waits for the display
+/// </summary>
+/// <param name=""></param>
+/// <returns>index of the buffer</returns>
+uint32_t swapchain_acquire(void) {
+    LOCK();
+    const uint32_t buffer = find(SWAP_FREE); //Always found, the display owns two buffers at most
+    states[buffer] = SWAP_DRAWING;
+    UNLOCK();
+    ++swapchain_stats.acquires;
+
+#if defined(USE_HAL_DRIVER)
+    hlcd_ltdc.LayerCfg[FOREGROUND_LAYER].FBStartAdress = buffer_addresses[buffer];
+#else
+    host_lcd_select(buffer);
+#endif // USE_HAL_DRIVER
+    return buffer;
+}
+
+/// <summary>
+/// Hands a completely drawn buffer to the display, it replaces a presented frame that is not on the screen yet
+/// </summary>
+/// <param name="buffer">index of the acquired buffer</param>
+void swapchain_present(uint32_t buffer) {
+    ++swapchain_stats.presents;
+    LOCK();
+    const uint32_t stale = find(SWAP_READY);
+    if (stale != NO_BUFFER) {
+        states[stale] = SWAP_FREE;
+        ++swapchain_stats.dropped;
+    }
+    states[buffer] = SWAP_READY;
+    UNLOCK();
+#if !defined(USE_HAL_DRIVER)
+    swapchain_blanking_irq(); //The host display switches at once
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Waits for the next vertical blanking, returns at once if there was one since the last wait. Paces the renderer to
+/// the refresh rate, the buffers do not depend on it
+/// </summary>
+/// <param name=""></param>
+void swapchain_wait(void) {
+#if defined(USE_HAL_DRIVER)
+    osThreadFlagsWait(SWAPCHAIN_BLANKING_FLAG, osFlagsWaitAny, osWaitForever);
+#endif // USE_HAL_DRIVER
+}
+
+/// <summary>
+/// Gets the buffer on the screen
+/// </summary>
+/// <param name=""></param>
+/// <returns>index of the buffer</returns>
+uint32_t swapchain_front_buffer(void) {
+    return find(SWAP_SCANOUT);
+}
+
+/// <summary>
+/// Switches the display to the latest presented buffer, frees the one that was on the screen and wakes up the
+/// renderer, called from the line interrupt of the LTDC at the start of the vertical blanking
+/// </summary>
+/// <param name=""></param>
+void swapchain_blanking_irq(void) {
+    const uint32_t current = find(SWAP_READY);
+    if (current != NO_BUFFER) {
+        const uint32_t previous = find(SWAP_SCANOUT);
+        if (previous != NO_BUFFER) {
+            states[previous] = SWAP_FREE;
+        }
+        states[current] = SWAP_SCANOUT;
+#if defined(USE_HAL_DRIVER)
+        //The layer registers are written directly, the address in the layer configuration is the one that is drawn
+        //into. The reload is immediate since the display is blanked until the next frame starts
+        LTDC_LAYER(&hlcd_ltdc, FOREGROUND_LAYER)->CFBAR = buffer_addresses[current];
+        LTDC->SRCR = LTDC_SRCR_IMR;
+#endif // USE_HAL_DRIVER
+        vsync_reload();
+        palette_reload_irq(); //The CLUT changes with the frame that is now on the screen
+    }
+#if defined(USE_HAL_DRIVER)
+    arm_blanking(); //The HAL disables the line interrupt before it calls back
+    if (task) {
+        osThreadFlagsSet((osThreadId_t)task, SWAPCHAIN_BLANKING_FLAG);
+    }
+#endif // USE_HAL_DRIVER
+}
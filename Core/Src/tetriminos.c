@@ -0,0 +1,42 @@
+/*
+ * tetriminos.c
+ */
+
+#include "tetriminos.h"
+
+//Shapes of every rotation, bit (j + i * 4) is the box in row i and column 3 - j
+#define TETRIMINO_LIST(X)                       \
+    X(0x0000, 0x0000, 0x0000, 0x0000)           \
+    X(0x0F00, 0x2222, 0x00F0, 0x4444)   /*I*/   \
+    X(0xCC00, 0xCC00, 0xCC00, 0xCC00)   /*O*/   \
+    X(0x0E40, 0x4C40, 0x4E00, 0x4640)   /*T*/   \
+    X(0x06C0, 0x8C40, 0x6C00, 0x4620)   /*S*/   \
+    X(0x44C0, 0x8E00, 0x6440, 0x0E20)   /*J*/   \
+    X(0x0C60, 0x4C80, 0xC600, 0x2640)   /*Z*/   \
+    X(0x4460, 0x0E80, 0xC440, 0x2E00)   /*L*/
+
+#define NIBBLE(shape, row) (((shape) >> ((row) * 4)) & 0xf)
+#define REVERSE(n) ((((n) & 0x1) << 3) | (((n) & 0x2) << 1) | (((n) & 0x4) >> 1) | (((n) & 0x8) >> 3))
+#define COLUMNS(shape) REVERSE(NIBBLE(shape, 0) | NIBBLE(shape, 1) | NIBBLE(shape, 2) | NIBBLE(shape, 3))
+#define ROWS(shape) ((NIBBLE(shape, 0) != 0) | ((NIBBLE(shape, 1) != 0) << 1) | ((NIBBLE(shape, 2) != 0) << 2) | ((NIBBLE(shape, 3) != 0) << 3))
+#define LOWEST_BIT(n) (((n) & 0x1) ? 0 : ((n) & 0x2) ? 1 : ((n) & 0x4) ? 2 : 3)
+#define HIGHEST_BIT(n) (((n) & 0x8) ? 3 : ((n) & 0x4) ? 2 : ((n) & 0x2) ? 1 : 0)
+
+#define ROW_MASK(shape, row, x) ((uint16_t)(REVERSE(NIBBLE(shape, row)) << ((x) + X_WALL)))
+#define ROW_MASKS(shape, x) { ROW_MASK(shape, 0, x), ROW_MASK(shape, 1, x), ROW_MASK(shape, 2, x), ROW_MASK(shape, 3, x) }
+#define POSITION_MASKS(shape) {                                                                 \
+    ROW_MASKS(shape, -3), ROW_MASKS(shape, -2), ROW_MASKS(shape, -1), ROW_MASKS(shape, 0),      \
+    ROW_MASKS(shape, 1), ROW_MASKS(shape, 2), ROW_MASKS(shape, 3), ROW_MASKS(shape, 4),         \
+    ROW_MASKS(shape, 5), ROW_MASKS(shape, 6), ROW_MASKS(shape, 7), ROW_MASKS(shape, 8),         \
+    ROW_MASKS(shape, 9) }
+#define MASKS(shape) { POSITION_MASKS(shape),                                                   \
+    LOWEST_BIT(COLUMNS(shape)), HIGHEST_BIT(COLUMNS(shape)), LOWEST_BIT(ROWS(shape)), HIGHEST_BIT(ROWS(shape)) }
+
+#define TETRIMINO_SHAPES(r0, r1, r2, r3) { r0, r1, r2, r3 },
+#define TETRIMINO_MASKS(r0, r1, r2, r3) { MASKS(r0), MASKS(r1), MASKS(r2), MASKS(r3) },
+
+_Static_assert(X_POSITIONS == 13, "POSITION_MASKS has to list every x from -X_WALL to X_DIM - 1");
+
+const uint16_t tetriminos[8][4] = { TETRIMINO_LIST(TETRIMINO_SHAPES) };
+
+const tetrimino_masks_t tetrimino_masks[8][4] = { TETRIMINO_LIST(TETRIMINO_MASKS) };
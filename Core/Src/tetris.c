@@ -18,16 +18,6 @@ const uint32_t colors[8] = {
         UTIL_LCD_COLOR_RED,			//Z
         UTIL_LCD_COLOR_ORANGE };    //L
 
-const uint16_t tetriminos[8][4] = {
-        { 0x0000, 0x0000, 0x0000, 0x0000 },
-        { 0x0F00, 0x2222, 0x00F0, 0x4444 },   //I
-        { 0xCC00, 0xCC00, 0xCC00, 0xCC00 },   //O
-        { 0x0E40, 0x4C40, 0x4E00, 0x4640 },   //T
-        { 0x06C0, 0x8C40, 0x6C00, 0x4620 },   //S
-        { 0x44C0, 0x8E00, 0x6440, 0x0E20 },   //J
-        { 0x0C60, 0x4C80, 0xC600, 0x2640 },   //Z
-        { 0x4460, 0x0E80, 0xC440, 0x2E00 } }; //L
-
 button_t buttons[N_BTN] = {
     { X_BTN_PADDING, LCD_DEFAULT_HEIGHT - Y_BTN_PADDING - Y_BTN, MOVE_LEFT, 0, { {0, 0}, {1, 1}, 0} },
     { X_BTN_PADDING, LCD_DEFAULT_HEIGHT - Y_BTN_PADDING * 2 - Y_BTN * 2, ROTATE_LEFT, 0, { {1, 1}, {1, 1}, 0} },
@@ -41,7 +31,8 @@ const uint8_t level_speed[] = { 72, 64, 58, 50, 44, 36, 30, 22, 14, 10, 8, 8, 8,
 const uint16_t lines_score[] = { 0, 100, 300, 500, 800 };
 uint32_t top_scores[MMC_BLOCKSIZE / sizeof(uint32_t)];
 
-uint8_t playing_field[Y_DIM][X_DIM];
+uint8_t playing_field[Y_DIM][X_DIM];      //Colors of the placed boxes, only used for drawing
+uint16_t playing_field_rows[Y_DIM];       //Occupancy of the placed boxes, one bit per column
 tetrimino_t tetrimino;
 uint32_t time;
 uint32_t level;
@@ -52,6 +43,20 @@ uint32_t lines_cleared;
 bool playing = false;
 bool game_over = false;
 
+frame_t frames[N_FRAME_BUFFERS];
+bool background_drawn = false; //The border and the frames of the buttons never change
+
+label_t time_label = { .format = "Time: %lds", .x = 4, .y = 10, .mode = LEFT_MODE,
+    .bitmap = (uint8_t*)LCD_LABEL_ADDRESS, .capacity = LCD_LABEL_SIZE };
+label_t score_label = { .format = "Score: %ld, Level: %ld", .x = 0, .y = 10, .mode = RIGHT_MODE,
+    .bitmap = (uint8_t*)(LCD_LABEL_ADDRESS + LCD_LABEL_SIZE), .capacity = LCD_LABEL_SIZE };
+uint32_t hud_rasterizations_per_minute;
+
+sprite_t button_sprites[N_BTN][2][2]; //Indexed by button, pressed state and selected polygon
+uint32_t button_polygon_cycles; //Average cost of painting a button from its polygons
+uint32_t button_sprite_cycles;  //Average cost of blitting a button sprite
+sprite_t box_tiles[8]; //Pre-rendered boxes indexed by color
+
 /// <summary>
 /// Loads the top scores from the EMMC flash
 /// </summary>
@@ -99,19 +104,11 @@ static void finish_game(void) {
 /// <param name="type"></param>
 /// <returns></returns>
 static int8_t get_new_x_position(uint8_t type) {
-    static uint16_t masks[] = { 0x8888, 0x4444, 0x2222, 0x1111 };
+    const tetrimino_masks_t* masks = &tetrimino_masks[type][0];
     uint32_t x;
 
-    uint8_t min = 4, max = 0;
-    const uint16_t tetrimino = tetriminos[type][0];
-    for (size_t i = 0; i < 4; ++i) {
-        if ((tetrimino & masks[i]) != 0) {
-            min = MIN(min, i);
-            max = MAX(max, i);
-        }
-    }
     HAL_RNG_GenerateRandomNumber(&rng, &x);
-    return min + x % (X_DIM - max - min);
+    return masks->left + x % (X_DIM - masks->right - masks->left);
 }
 
 /// <summary>
@@ -120,16 +117,7 @@ static int8_t get_new_x_position(uint8_t type) {
 /// <param name="type"></param>
 /// <returns></returns>
 static int8_t get_new_y_position(uint8_t type) {
-    static uint16_t masks[] = { 0x000f, 0x00f0, 0x0f00, 0xf000 };
-
-    const uint16_t tetrimino = tetriminos[type][0];
-    for (size_t i = 0; i < 4; ++i) {
-        if ((tetrimino & masks[i]) != 0) {
-            return Y_DIM - i;
-        }
-    }
-
-    return Y_DIM;
+    return Y_DIM - tetrimino_masks[type][0].bottom;
 }
 
 /// <summary>
@@ -148,9 +136,9 @@ static void create_tetrimino(tetrimino_t* tetrimino) {
 /// <summary>
 /// Draws a banner displaying the game over sign
 /// </summary>
-/// <param name=""></param>
-static void draw_game_over(void) {
-    if (game_over) {
+/// <param name="snapshot">of the game</param>
+static void draw_game_over(const snapshot_t* snapshot) {
+    if (snapshot->banner == BANNER_GAME_OVER) {
         UTIL_LCD_SetFont(&UTIL_LCD_DEFAULT_FONT);
         UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_DARKGRAY);
         UTIL_LCD_FillRect(X_BANNER_START, Y_BANNER_START, X_BANNER_DIM, Y_BANNER_DIM, UTIL_LCD_COLOR_DARKGRAY);
@@ -162,10 +150,10 @@ static void draw_game_over(void) {
 /// <summary>
 /// Draws a banner displaying top 3 scores
 /// </summary>
-/// <param name=""></param>
-static void draw_scores(void) {
+/// <param name="snapshot">of the game</param>
+static void draw_scores(const snapshot_t* snapshot) {
     static char buf[32];
-    if (!game_over && !playing) {
+    if (snapshot->banner == BANNER_SCORES) {
         UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_DARKGRAY);
         UTIL_LCD_FillRect(X_BANNER_START, Y_BANNER_START, X_BANNER_DIM, Y_BANNER_DIM, UTIL_LCD_COLOR_DARKGRAY);
 
@@ -174,7 +162,7 @@ static void draw_scores(void) {
 
         UTIL_LCD_SetFont(&Font16);
         for (size_t i = 0; i < N_TOP_SCORES; ++i) {
-            sprintf(buf, "%d: %d", i + 1, top_scores[i]);
+            sprintf(buf, "%d: %d", i + 1, snapshot->top_scores[i]);
             UTIL_LCD_DisplayStringAt(0, Y_BANNER_START + 40 + 16 * i, (uint8_t*)buf, CENTER_MODE);
         }
         UTIL_LCD_SetFont(&Font12);
@@ -182,42 +170,54 @@ static void draw_scores(void) {
 }
 
 /// <summary>
-/// Draws a box with the selected color
+/// Paints a box with the selected color and its outline
 /// </summary>
 /// <param name="x">position of the box</param>
 /// <param name="y">position of the box</param>
 /// <param name="color">of the box</param>
-static void draw_box(uint16_t x, uint16_t y, uint8_t color) {
+static void paint_box(uint16_t x, uint16_t y, uint8_t color) {
     UTIL_LCD_FillRect(x, y, X_BOX, Y_BOX, colors[color]);
     UTIL_LCD_DrawRect(x, y, X_BOX, Y_BOX, UTIL_LCD_COLOR_GRAY);
 }
 
 /// <summary>
-/// Draws the current tetrimino
+/// Draws a box with the selected color by blitting its tile, the box is painted if the atlas had no room for the tile
 /// </summary>
-/// <param name=""></param>
-static void draw_tetrimino(void) {
-    if (tetrimino.type != 0) {
-        const uint16_t shape = tetriminos[tetrimino.type][tetrimino.dir];
-        for (size_t i = 0; i < 4; ++i) {
-            for (size_t j = 0; j < 4; ++j) {
-                if (shape & 1 << (j + i * 4)) {
-                    draw_box(X_START + (tetrimino.x + 3 - j) * X_BOX, Y_START - (tetrimino.y + i) * Y_BOX, tetrimino.type);
-                }
-            }
-        }
+/// <param name="x">position of the box</param>
+/// <param name="y">position of the box</param>
+/// <param name="color">of the box</param>
+static void draw_box(uint16_t x, uint16_t y, uint8_t color) {
+    if (box_tiles[color].pixels != NULL) {
+        sprite_draw(&box_tiles[color], x, y);
+    } else {
+        paint_box(x, y, color);
     }
 }
 
 /// <summary>
-/// Draws the boxes in the playing field
+/// Clears a box, the background layer shows through it
 /// </summary>
-/// <param name=""></param>
-static void draw_playing_field(void) {
-    for (size_t i = 0; i < Y_DIM; ++i) {
+/// <param name="x">position of the box</param>
+/// <param name="y">position of the box</param>
+static void clear_box(uint16_t x, uint16_t y) {
+    UTIL_LCD_FillRect(x, y, X_BOX, Y_BOX, TRANSPARENT_COLOR);
+}
+
+/// <summary>
+/// Draws the boxes of the frame that differ from the previous frame
+/// </summary>
+/// <param name="frame">to be drawn</param>
+/// <param name="previous">contents of the buffer, NULL if the buffer is empty</param>
+static void draw_cells(const frame_t* frame, const frame_t* previous) {
+    for (size_t i = 0; i < Y_FRAME; ++i) {
         for (size_t j = 0; j < X_DIM; ++j) {
-            if (playing_field[i][j] != 0) {
-                draw_box(X_START + j * X_BOX, Y_START - i * Y_BOX, playing_field[i][j]);
+            const uint8_t cell = frame->cells[i][j];
+            if (previous == NULL ? cell != 0 : cell != previous->cells[i][j]) {
+                if (cell != 0) {
+                    draw_box(X_START + j * X_BOX, Y_START - i * Y_BOX, cell);
+                } else {
+                    clear_box(X_START + j * X_BOX, Y_START - i * Y_BOX);
+                }
             }
         }
     }
@@ -256,10 +256,10 @@ static void draw_border(void) {
 }
 
 /// <summary>
-/// Draws a button
+/// Paints a button from its polygons, only used to fill the sprite atlas
 /// </summary>
-/// <param name="btn">button to be drawn</param>
-static void draw_button(button_t btn) {
+/// <param name="btn">button to be painted</param>
+static void paint_button(button_t btn) {
     const uint32_t border_color = ((btn.state & 0x1) == 1) ? UTIL_LCD_COLOR_DARKGRAY : UTIL_LCD_COLOR_GRAY;
     const uint8_t selected = btn.polygon.selected;
     UTIL_LCD_FillRect(btn.x, btn.y, X_BTN, Y_BTN, border_color);
@@ -271,29 +271,105 @@ static void draw_button(button_t btn) {
 }
 
 /// <summary>
-/// Draws buttons required for the game
+/// Draws the button in the state of the frame from the sprite atlas
+/// </summary>
+/// <param name="i">index of the button</param>
+/// <param name="state">pressed state in bit 0, selected polygon in bit 1</param>
+static void draw_button(size_t i, uint8_t state) {
+    sprite_draw(&button_sprites[i][state & 0x1][state >> 1], buttons[i].x, buttons[i].y);
+}
+
+/// <summary>
+/// Draws the buttons of the frame that differ from the previous frame
+/// </summary>
+/// <param name="frame">to be drawn</param>
+/// <param name="previous">contents of the buffer, NULL if the buffer is empty</param>
+static void draw_buttons(const frame_t* frame, const frame_t* previous) {
+    for (size_t i = 0; i < N_BTN; ++i) {
+        if (previous == NULL || frame->buttons[i] != previous->buttons[i]) {
+            draw_button(i, frame->buttons[i]);
+        }
+    }
+}
+
+/// <summary>
+/// Draws the border and the frames of the buttons once into the background layer, which is shared by every frame buffer
+/// and on the screen while it is drawn into. The state of the buttons is drawn into the frame buffers, so that it is
+/// presented with the frame it belongs to
 /// </summary>
 /// <param name=""></param>
-static void draw_buttons(void) {
+static void draw_background(void) {
+    if (background_drawn) {
+        return;
+    }
+    UTIL_LCD_SetLayer(BACKGROUND_LAYER);
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    draw_border();
     for (size_t i = 0; i < N_BTN; ++i) {
-        draw_button(buttons[i]);
+        UTIL_LCD_DrawRect(buttons[i].x, buttons[i].y, X_BTN, Y_BTN, UTIL_LCD_COLOR_LIGHTGRAY);
     }
+    background_drawn = true;
+    UTIL_LCD_SetLayer(FOREGROUND_LAYER);
 }
 
 /// <summary>
-/// Creates a 16bit 4x4 mask where 1 represents invalid fields
+/// Draws the time and score labels that differ from the ones in the buffer
 /// </summary>
-/// <param name="x">position of the bottom left corner</param>
-/// <param name="y">position of the bottom left corner</param>
-/// <returns>mask</returns>
-static uint16_t overlap_mask(int8_t x, int8_t y) {
-    uint16_t mask = 0;
-    for (int32_t i = 3; i >= 0; --i) {
-        for (int32_t j = 0; j < 4; ++j) {
-            mask = (mask << 1) | ((x + j < 0) || (y + i < 0) || (x + j >= X_DIM) || ((y + i < Y_DIM) && (playing_field[y + i][x + j] != 0)));
-        }
+/// <param name="previous">contents of the buffer, NULL if the buffer is empty</param>
+static void draw_hud(const frame_t* previous) {
+    UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_BLACK);
+    label_draw(&time_label, previous ? &previous->time : NULL);
+    label_draw(&score_label, previous ? &previous->score : NULL);
+}
+
+/// <summary>
+/// Rasterizes the time and score labels again if their values changed
+/// </summary>
+/// <param name="snapshot">of the game</param>
+static void update_hud(const snapshot_t* snapshot) {
+    static uint32_t last_time = 0;
+    //reset_game runs in the logic task, the renderer sees the reset as the game time going back and restarts the counts
+    //so that the rate covers the same game as the time it is divided by
+    if (snapshot->time < last_time) {
+        time_label.rasterizations = 0;
+        score_label.rasterizations = 0;
+    }
+    last_time = snapshot->time;
+    UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_BLACK);
+    label_update(&time_label, snapshot->time / TIME_DIV, 0);
+    label_update(&score_label, snapshot->score, snapshot->level);
+    if (snapshot->time >= TIME_DIV) {
+        hud_rasterizations_per_minute = (time_label.rasterizations + score_label.rasterizations) * 60 * TIME_DIV / snapshot->time;
     }
-    return mask;
+}
+
+/// <summary>
+/// Captures everything that is visible on the screen
+/// </summary>
+/// <param name="frame">where the state is stored</param>
+/// <param name="snapshot">of the game</param>
+static void compose_frame(frame_t* frame, const snapshot_t* snapshot) {
+    memcpy(frame->cells, snapshot->cells, sizeof(frame->cells));
+    memcpy(frame->buttons, snapshot->buttons, sizeof(frame->buttons));
+    update_hud(snapshot);
+    frame->time = label_state(&time_label);
+    frame->score = label_state(&score_label);
+    frame->banner = snapshot->banner;
+    frame->valid = true;
+}
+
+/// <summary>
+/// Gets the occupancy row of the playing field including the walls, the floor and the empty space above the field
+/// </summary>
+/// <param name="y">row index</param>
+/// <returns>row occupancy mask</returns>
+static uint16_t field_row(int8_t y) {
+    if (y < 0) {
+        return FULL_ROW;
+    } else if (y >= Y_DIM) {
+        return EMPTY_ROW;
+    }
+    return playing_field_rows[y];
 }
 
 /// <summary>
@@ -305,7 +381,14 @@ static uint16_t overlap_mask(int8_t x, int8_t y) {
 /// <param name="y">position of the left bottom corner</param>
 /// <returns></returns>
 static bool valid(uint8_t type, uint8_t dir, int8_t x, int8_t y) {
-    return (overlap_mask(x, y) & tetriminos[type][dir]) == 0;
+    const tetrimino_masks_t* masks = &tetrimino_masks[type][dir];
+    if (x < -masks->left || x >= X_DIM - masks->right) {
+        return false;
+    }
+
+    //Rows of the 4x4 box outside of the piece are empty, so all four are tested without a data dependent loop
+    const uint16_t* rows = masks->rows[x + X_WALL];
+    return ((field_row(y) & rows[0]) | (field_row(y + 1) & rows[1]) | (field_row(y + 2) & rows[2]) | (field_row(y + 3) & rows[3])) == 0;
 }
 
 /// <summary>
@@ -323,20 +406,25 @@ static void place_on_playing_field(uint8_t type, uint8_t dir, int8_t x, int8_t y
     }
 
     score += 2 * drop_count;
-    const uint16_t tetrimino = tetriminos[type][dir];
-    uint16_t mask = 1;
-    for (int32_t i = 0; i < 4; ++i) {
-        for (int32_t j = 3; j >= 0; --j) {
-            if ((mask & tetrimino) != 0) {
-                if (x + j >= 0 && x + j < X_DIM && y + i >= 0 && y + i < Y_DIM) {
-                    playing_field[y + i][x + j] = type;
-                } else {
-                    finish_game();
+    const tetrimino_masks_t* masks = &tetrimino_masks[type][dir];
+    const uint16_t* rows = masks->rows[x + X_WALL];
+    bool overflow = false;
+    for (int32_t i = masks->bottom; i <= masks->top; ++i) {
+        if (y + i < Y_DIM) {
+            playing_field_rows[y + i] |= rows[i];
+            for (int32_t j = x + masks->left; j <= x + masks->right; ++j) {
+                if ((rows[i] & (1 << (j + X_WALL))) != 0) {
+                    playing_field[y + i][j] = type;
                 }
             }
-            mask <<= 1;
+        } else if (rows[i] != 0) {
+            overflow = true;
         }
     }
+    //The game ends once per placement, no matter how many rows stick out above the field
+    if (overflow) {
+        finish_game();
+    }
 }
 
 /// <summary>
@@ -348,10 +436,7 @@ void clear_lines(void) {
 
     //Find full lines
     for (size_t i = 0; i < Y_DIM; ++i) {
-        full[i] = true;
-        for (size_t j = 0; j < X_DIM; ++j) {
-            full[i] = full[i] && (playing_field[i][j] != 0);
-        }
+        full[i] = playing_field_rows[i] == FULL_ROW;
     }
 
     //Remove full lines
@@ -359,6 +444,7 @@ void clear_lines(void) {
     for (size_t i = 0; i < Y_DIM; ++i) {
         if (!full[i]) {
             if (i != y) {
+                playing_field_rows[y] = playing_field_rows[i];
                 memmove(playing_field[y++], playing_field[i], X_DIM * sizeof(uint8_t));
             } else {
                 ++y;
@@ -368,6 +454,7 @@ void clear_lines(void) {
 
     //Clear old lines
     for (size_t i = y; i < Y_DIM; ++i) {
+        playing_field_rows[i] = EMPTY_ROW;
         memset(playing_field[i], 0, X_DIM * sizeof(uint8_t));
     }
 
@@ -449,25 +536,119 @@ void update_state(void) {
 }
 
 /// <summary>
-/// Renders the image onto the screen
+/// Captures the state of the game for the renderer
+/// </summary>
+/// <param name="snapshot">where the state is stored</param>
+void take_snapshot(snapshot_t* snapshot) {
+    memcpy(snapshot->cells, playing_field, sizeof(playing_field));
+    memset(snapshot->cells[Y_DIM], 0, sizeof(snapshot->cells) - sizeof(playing_field));
+
+    if (tetrimino.type != 0) {
+        const uint16_t shape = tetriminos[tetrimino.type][tetrimino.dir];
+        for (int32_t i = 0; i < 4; ++i) {
+            for (int32_t j = 0; j < 4; ++j) {
+                const int32_t y = tetrimino.y + i;
+                const int32_t x = tetrimino.x + 3 - j;
+                if ((shape & 1 << (j + i * 4)) && y >= 0 && y < Y_FRAME && x >= 0 && x < X_DIM) {
+                    snapshot->cells[y][x] = tetrimino.type;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < N_BTN; ++i) {
+        snapshot->buttons[i] = (buttons[i].state & 0x1) | (buttons[i].polygon.selected << 1);
+    }
+
+    snapshot->time = time;
+    snapshot->score = score;
+    snapshot->level = level;
+    memcpy(snapshot->top_scores, top_scores, sizeof(snapshot->top_scores));
+    snapshot->banner = game_over ? BANNER_GAME_OVER : (!playing ? BANNER_SCORES : BANNER_NONE);
+}
+
+/// <summary>
+/// Renders a snapshot of the game onto the screen by redrawing only the parts that changed since the buffer was last drawn
+/// </summary>
+/// <param name="buffer">index of the frame buffer that is drawn into</param>
+/// <param name="snapshot">of the game, only read</param>
+void render(uint32_t buffer, const snapshot_t* snapshot) {
+    static frame_t frame;
+    frame_t* previous = &frames[buffer];
+
+    compose_frame(&frame, snapshot);
+    UTIL_LCD_BeginFrame(); //The buffer was just acquired, its address is looked up once for the direct writes
+
+    //Banners are drawn over the boxes
+    const bool redraw = !previous->valid ||
+        frame.banner != previous->banner ||
+        (frame.banner != BANNER_NONE && memcmp(frame.cells, previous->cells, sizeof(frame.cells)) != 0);
+
+    draw_background();
+
+    if (redraw) {
+        UTIL_LCD_Clear(TRANSPARENT_COLOR);
+        previous = NULL;
+    }
+
+    draw_cells(&frame, previous);
+    draw_buttons(&frame, previous);
+    draw_hud(previous);
+
+    if (redraw) {
+        draw_game_over(snapshot);
+        draw_scores(snapshot);
+    }
+
+    frames[buffer] = frame;
+}
+
+/// <summary>
+/// Paints every variant of the buttons and every box color once and captures them into the sprite atlas, also
+/// measures how much cheaper blitting a sprite is than painting the button from its polygons
 /// </summary>
 /// <param name=""></param>
-void render(void) {
-    static char str_buffer[32];
+void init_sprites(void) {
+    size_t variants = 0;
+    uint32_t polygon_cycles = 0;
+    uint32_t sprite_cycles = 0;
+    for (size_t i = 0; i < N_BTN; ++i) {
+        for (uint8_t state = 0; state < 2; ++state) {
+            for (uint8_t selected = 0; selected < 2; ++selected) {
+                button_t btn = buttons[i];
+                btn.state = state;
+                btn.polygon.selected = selected;
+                if (selected == 1 && btn.polygon.polygon[1] == btn.polygon.polygon[0] && btn.polygon.count[1] == btn.polygon.count[0]) {
+                    button_sprites[i][state][1] = button_sprites[i][state][0]; //Same icon in both variants
+                    continue;
+                }
 
-    draw_border();
-    draw_playing_field();
-    draw_buttons();
-    draw_tetrimino();
+                uint32_t start = DWT->CYCCNT;
+                paint_button(btn);
+                dma2d_fence();
+                polygon_cycles += DWT->CYCCNT - start;
 
-    UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_BLACK);
-    sprintf(str_buffer, "Time: %lds", time / TIME_DIV);
-    UTIL_LCD_DisplayStringAt(4, 10, (uint8_t*)str_buffer, LEFT_MODE);
-    sprintf(str_buffer, "Score: %ld, Level: %ld", score, level);
-    UTIL_LCD_DisplayStringAt(0, 10, (uint8_t*)str_buffer, RIGHT_MODE);
+                sprite_capture(&button_sprites[i][state][selected], btn.x, btn.y, X_BTN, Y_BTN);
 
-    draw_game_over();
-    draw_scores();
+                start = DWT->CYCCNT;
+                sprite_draw(&button_sprites[i][state][selected], btn.x, btn.y);
+                dma2d_fence();
+                sprite_cycles += DWT->CYCCNT - start;
+                ++variants;
+            }
+        }
+    }
+    button_polygon_cycles = polygon_cycles / variants;
+    button_sprite_cycles = sprite_cycles / variants;
+
+    //A changed cell is then a single blit instead of a fill and the four lines of its outline
+    for (uint8_t color = 0; color < sizeof(box_tiles) / sizeof(box_tiles[0]); ++color) {
+        paint_box(X_START, Y_START, color);
+        dma2d_fence();
+        if (!sprite_capture(&box_tiles[color], X_START, Y_START, X_BOX, Y_BOX)) {
+            box_tiles[color].pixels = NULL;
+        }
+    }
 }
 
 /// <summary>
@@ -485,6 +666,9 @@ void reset_game(void) {
     create_tetrimino(&tetrimino);
     load_top_scores();
     memset(playing_field, 0, X_DIM * Y_DIM * sizeof(uint8_t));
+    for (size_t i = 0; i < Y_DIM; ++i) {
+        playing_field_rows[i] = EMPTY_ROW;
+    }
 }
 
 /// <summary>
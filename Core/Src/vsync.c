@@ -0,0 +1,67 @@
+/*
+ * vsync.c
+ */
+#include "vsync.h"
+#include "main.h"
+
+#if defined(USE_HAL_DRIVER)
+#define CYCLES_PER_US (SystemCoreClock / 1000000U)
+#else
+#define CYCLES_PER_US 1000U //The host cycle counter counts nanoseconds
+#endif // USE_HAL_DRIVER
+
+static uint32_t presented_tag = 0;
+static uint32_t last_reload = 0;
+
+vsync_stats_t vsync_stats = { 0 };
+
+/// <summary>
+/// Measures the refresh period of the display
+/// </summary>
+/// <param name=""></param>
+void vsync_init(void) {
+#if defined(USE_HAL_DRIVER)
+    //Every refresh scans the total width and height of the panel, blanking included, at the pixel clock of PLL3 R
+    PLL3_ClocksTypeDef pll3;
+    HAL_RCCEx_GetPLL3ClockFreq(&pll3);
+    const uint32_t total_width = ((LTDC->TWCR & LTDC_TWCR_TOTALW) >> LTDC_TWCR_TOTALW_Pos) + 1;
+    const uint32_t total_height = (LTDC->TWCR & LTDC_TWCR_TOTALH) + 1;
+    vsync_stats.refresh_us = (uint32_t)((uint64_t)total_width * total_height * 1000000U / pll3.PLL3_R_Frequency);
+#else
+    vsync_stats.refresh_us = VSYNC_HOST_REFRESH_US;
+#endif // USE_HAL_DRIVER
+    vsync_stats.min_interval_us = UINT32_MAX;
+}
+
+/// <summary>
+/// Counts a presented frame
+/// </summary>
+/// <param name="tag">identifies the contents of the frame, equal tags of consecutive frames count as duplicates</param>
+void vsync_present(uint32_t tag) {
+    if (vsync_stats.presents != 0 && tag == presented_tag) {
+        ++vsync_stats.duplicated;
+    }
+    presented_tag = tag;
+    ++vsync_stats.presents;
+}
+
+/// <summary>
+/// Measures the interval since the previous frame went on the screen, called from the blanking interrupt
+/// </summary>
+/// <param name=""></param>
+void vsync_reload(void) {
+    const uint32_t now = DWT->CYCCNT;
+    if (vsync_stats.reloads != 0) {
+        const uint32_t interval_us = (now - last_reload) / CYCLES_PER_US;
+        const uint32_t refreshes = (interval_us + vsync_stats.refresh_us / 2) / vsync_stats.refresh_us;
+        if (refreshes > 1) {
+            vsync_stats.missed += refreshes - 1;
+        }
+        vsync_stats.last_interval_us = interval_us;
+        vsync_stats.min_interval_us = MIN(vsync_stats.min_interval_us, interval_us);
+        vsync_stats.max_interval_us = MAX(vsync_stats.max_interval_us, interval_us);
+        vsync_stats.total_interval_us += interval_us;
+    }
+    last_reload = now;
+    ++vsync_stats.reloads;
+}
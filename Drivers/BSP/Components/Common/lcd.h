@@ -62,6 +62,13 @@
 /** @defgroup LCD_Driver_structure  LCD Driver structure
   * @{
   */
+typedef struct
+{
+  uint8_t  *pAddress;    /*!< First pixel of the frame buffer of the active layer */
+  uint32_t Stride;       /*!< Bytes from the start of one line to the next        */
+  uint32_t PixelFormat;  /*!< LCD_PIXEL_FORMAT_* of the frame buffer              */
+} LCD_UTILS_FrameBuffer_t;
+
 typedef struct
 {
   int32_t ( *DrawBitmap      ) (uint32_t, uint32_t, uint32_t, uint8_t *);
@@ -75,6 +82,10 @@ typedef struct
   int32_t ( *GetYSize        ) (uint32_t, uint32_t *);
   int32_t ( *SetLayer        ) (uint32_t, uint32_t);
   int32_t ( *GetFormat       ) (uint32_t, uint32_t *);
+  /* Optional, NULL when the frame buffer cannot be written by the CPU. Sync takes the first line and the number
+     of lines the CPU is about to write */
+  int32_t ( *GetFrameBuffer  ) (uint32_t, LCD_UTILS_FrameBuffer_t *);
+  int32_t ( *Sync            ) (uint32_t, uint32_t, uint32_t);
 } LCD_UTILS_Drv_t;
 
 typedef struct
@@ -257,6 +257,8 @@ int32_t FT5336_GetState(FT5336_Object_t *pObj, FT5336_State_t *State)
 
 /**
   * @brief  Get the touch screen Xn and Yn positions values in multi-touch mode
+  * @note   Only the registers of the detected touches are read, so a single touch
+  *         costs about as much as FT5336_GetState and no touch skips the read
   * @param  pObj Component object pointer
   * @param  State Multi Touch structure pointer
   * @retval FT5336_OK.
@@ -266,27 +268,39 @@ int32_t FT5336_GetMultiTouchState(FT5336_Object_t *pObj, FT5336_MultiTouch_State
   int32_t ret = FT5336_OK;
   uint8_t  data[30];
   uint32_t i;
+  int32_t nb_touch = FT5336_DetectTouch(pObj);
 
-  State->TouchDetected = (uint32_t)FT5336_DetectTouch(pObj);
-
-  if(ft5336_read_reg(&pObj->Ctx, FT5336_P1_XH_REG, data, (uint16_t)sizeof(data)) != FT5336_OK)
+  if(nb_touch < 0)
   {
+    State->TouchDetected = 0U;
     ret = FT5336_ERROR;
   }
   else
   {
-    for(i = 0; i < FT5336_MAX_NB_TOUCH; i++)
+    State->TouchDetected = (uint32_t)nb_touch;
+  }
+
+  if((ret == FT5336_OK) && (State->TouchDetected != 0U))
+  {
+    if(ft5336_read_reg(&pObj->Ctx, FT5336_P1_XH_REG, data, (uint16_t)(State->TouchDetected * 6U)) != FT5336_OK)
     {
-    /* Send back first ready X position to caller */
-    State->TouchX[i] = (((uint32_t)data[i*6U] & FT5336_P1_XH_TP_BIT_MASK) << 8U) | ((uint32_t)data[(i*6U) + 1U] & FT5336_P1_XL_TP_BIT_MASK);
-    /* Send back first ready Y position to caller */
-    State->TouchY[i] = (((uint32_t)data[(i*6U) + 2U] & FT5336_P1_YH_TP_BIT_MASK) << 8U) | ((uint32_t)data[(i*6U) + 3U] & FT5336_P1_YL_TP_BIT_MASK);
-    /* Send back first ready Event to caller */
-    State->TouchEvent[i] = (((uint32_t)data[i*6U] & FT5336_P1_XH_EF_BIT_MASK) >> FT5336_P1_XH_EF_BIT_POSITION);
-    /* Send back first ready Weight to caller */
-    State->TouchWeight[i] = ((uint32_t)data[(i*6U) + 4U] & FT5336_P1_WEIGHT_BIT_MASK);
-    /* Send back first ready Area to caller */
-    State->TouchArea[i] = ((uint32_t)data[(i*6U) + 5U] & FT5336_P1_MISC_BIT_MASK) >> FT5336_P1_MISC_BIT_POSITION;
+      ret = FT5336_ERROR;
+    }
+    else
+    {
+      for(i = 0; i < State->TouchDetected; i++)
+      {
+      /* Send back first ready X position to caller */
+      State->TouchX[i] = (((uint32_t)data[i*6U] & FT5336_P1_XH_TP_BIT_MASK) << 8U) | ((uint32_t)data[(i*6U) + 1U] & FT5336_P1_XL_TP_BIT_MASK);
+      /* Send back first ready Y position to caller */
+      State->TouchY[i] = (((uint32_t)data[(i*6U) + 2U] & FT5336_P1_YH_TP_BIT_MASK) << 8U) | ((uint32_t)data[(i*6U) + 3U] & FT5336_P1_YL_TP_BIT_MASK);
+      /* Send back first ready Event to caller */
+      State->TouchEvent[i] = (((uint32_t)data[i*6U] & FT5336_P1_XH_EF_BIT_MASK) >> FT5336_P1_XH_EF_BIT_POSITION);
+      /* Send back first ready Weight to caller */
+      State->TouchWeight[i] = ((uint32_t)data[(i*6U) + 4U] & FT5336_P1_WEIGHT_BIT_MASK);
+      /* Send back first ready Area to caller */
+      State->TouchArea[i] = ((uint32_t)data[(i*6U) + 5U] & FT5336_P1_MISC_BIT_MASK) >> FT5336_P1_MISC_BIT_POSITION;
+      }
     }
   }
 
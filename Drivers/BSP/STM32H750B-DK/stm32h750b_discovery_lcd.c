@@ -86,6 +86,7 @@
 #include "stm32h750b_discovery_ts.h"
 #include "stm32h750b_discovery_bus.h"
 #include "stm32h750b_discovery_sdram.h"
+#include "dma2d_queue.h"
 
 /** @addtogroup BSP
   * @{
@@ -123,7 +124,9 @@ const LCD_UTILS_Drv_t LCD_Driver =
   BSP_LCD_GetXSize,
   BSP_LCD_GetYSize,
   BSP_LCD_SetActiveLayer,
-  BSP_LCD_GetPixelFormat
+  BSP_LCD_GetPixelFormat,
+  BSP_LCD_GetFrameBuffer,
+  BSP_LCD_Sync
 };
 
 /**
@@ -201,7 +204,7 @@ int32_t BSP_LCD_InitEx(uint32_t Instance, uint32_t Orientation, uint32_t PixelFo
   MX_LTDC_LayerConfig_t config;
 
   if((Orientation > LCD_ORIENTATION_LANDSCAPE) || (Instance >= LCD_INSTANCES_NBR) || \
-     ((PixelFormat != LCD_PIXEL_FORMAT_RGB565) && (PixelFormat != LTDC_PIXEL_FORMAT_ARGB8888)))
+     ((PixelFormat != LCD_PIXEL_FORMAT_RGB565) && (PixelFormat != LTDC_PIXEL_FORMAT_ARGB8888) && (PixelFormat != LCD_PIXEL_FORMAT_L8)))
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
@@ -212,6 +215,12 @@ int32_t BSP_LCD_InitEx(uint32_t Instance, uint32_t Orientation, uint32_t PixelFo
       ltdc_pixel_format = LTDC_PIXEL_FORMAT_RGB565;
       Lcd_Ctx[Instance].BppFactor = 2U;
     }
+    else if(PixelFormat == LCD_PIXEL_FORMAT_L8)
+    {
+      /* Indexed colors, the layers look them up in their CLUT */
+      ltdc_pixel_format = LTDC_PIXEL_FORMAT_L8;
+      Lcd_Ctx[Instance].BppFactor = 1U;
+    }
     else /* LCD_PIXEL_FORMAT_RGB888 */
     {
       ltdc_pixel_format = LTDC_PIXEL_FORMAT_ARGB8888;
@@ -552,6 +561,56 @@ int32_t BSP_LCD_GetPixelFormat(uint32_t Instance, uint32_t *PixelFormat)
   return ret;
 }
 
+/**
+  * @brief  Gets the frame buffer of the active layer so it can be written by the CPU.
+  * @param  Instance    LCD Instance
+  * @param  FrameBuffer Address, stride and pixel format of the frame buffer
+  * @retval BSP status
+  */
+int32_t BSP_LCD_GetFrameBuffer(uint32_t Instance, LCD_UTILS_FrameBuffer_t *FrameBuffer)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if(Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    FrameBuffer->pAddress = (uint8_t *)hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress;
+    FrameBuffer->Stride = Lcd_Ctx[Instance].XSize * Lcd_Ctx[Instance].BppFactor;
+    FrameBuffer->PixelFormat = Lcd_Ctx[Instance].PixelFormat;
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  Waits for the queued DMA2D transfers that touch the lines of the active layer, so CPU writes to them
+  *         land after the transfers. Transfers to other lines keep running.
+  * @param  Instance    LCD Instance
+  * @param  Ypos        First line
+  * @param  Height      Number of lines
+  * @retval BSP status
+  */
+int32_t BSP_LCD_Sync(uint32_t Instance, uint32_t Ypos, uint32_t Height)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t stride;
+
+  if(Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    stride = Lcd_Ctx[Instance].XSize * Lcd_Ctx[Instance].BppFactor;
+    dma2d_sync(hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + (Ypos * stride), Height * stride);
+  }
+
+  return ret;
+}
+
 /**
   * @brief  Set the LCD Active Layer.
   * @param  Instance    LCD Instance
@@ -1060,33 +1119,63 @@ int32_t BSP_LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint
   */
 int32_t BSP_LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height)
 {
-  uint32_t i;
   uint8_t *pdata = pData;
 
 #if (USE_DMA2D_TO_FILL_RGB_RECT == 1)
-  uint32_t  Xaddress;
-  for(i = 0; i < Height; i++)
+  uint32_t Xaddress, input_color_mode, output_color_mode;
+  uint32_t size = Lcd_Ctx[Instance].BppFactor*Width*Height;
+  uint8_t *pstaged;
+  uint32_t unstaged;
+
+  /* Get the rectangle address */
+  Xaddress = hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + (Lcd_Ctx[Instance].BppFactor*((Lcd_Ctx[Instance].XSize*Ypos) + Xpos));
+
+  if(Lcd_Ctx[Instance].PixelFormat == LCD_PIXEL_FORMAT_RGB565)
   {
-    /* Get the line address */
-    Xaddress = hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + (Lcd_Ctx[Instance].BppFactor*((Lcd_Ctx[Instance].XSize*(Ypos + i)) + Xpos));
+    input_color_mode = DMA2D_INPUT_RGB565;
+    output_color_mode = DMA2D_OUTPUT_RGB565;
+  }
+  else if(Lcd_Ctx[Instance].PixelFormat == LCD_PIXEL_FORMAT_L8)
+  {
+    /* The DMA2D cannot convert to L8, the indices are copied as they are in memory-to-memory mode, which ignores
+       the output format */
+    input_color_mode = DMA2D_INPUT_L8;
+    output_color_mode = DMA2D_OUTPUT_ARGB8888;
+  }
+  else
+  {
+    input_color_mode = DMA2D_INPUT_ARGB8888;
+    output_color_mode = DMA2D_OUTPUT_ARGB8888;
+  }
+
+  /* The caller's buffer may not outlive this call, so the DMA2D reads a staged copy */
+  pstaged = (uint8_t *)dma2d_stage(pdata, size);
+  unstaged = (pstaged == NULL) ? 1U : 0U;
+  if(unstaged == 1U)
+  {
+    pstaged = pdata;
+  }
 
 #if (USE_BSP_CPU_CACHE_MAINTENANCE == 1)
-    SCB_CleanDCache_by_Addr((uint32_t *)pdata, Lcd_Ctx[Instance].BppFactor*Lcd_Ctx[Instance].XSize);
+  SCB_CleanDCache_by_Addr((uint32_t *)pstaged, size);
 #endif /* USE_BSP_CPU_CACHE_MAINTENANCE */
 
-    /* Write line */
-    if(Lcd_Ctx[Instance].PixelFormat == LCD_PIXEL_FORMAT_RGB565)
-    {
-      LL_ConvertLineToRGB(Instance, (uint32_t *)pdata, (uint32_t *)Xaddress, Width, DMA2D_INPUT_RGB565);
-    }
-    else
-    {
-      LL_ConvertLineToRGB(Instance, (uint32_t *)pdata, (uint32_t *)Xaddress, Width, DMA2D_INPUT_ARGB8888);
-    }
-    pdata += Lcd_Ctx[Instance].BppFactor*Width;
+  /* Write the whole rectangle with a single transfer */
+  if(Lcd_Ctx[Instance].PixelFormat == LCD_PIXEL_FORMAT_L8)
+  {
+    dma2d_copy((uint32_t)pstaged, 0, Xaddress, Lcd_Ctx[Instance].XSize - Width, input_color_mode, Width, Height);
+  }
+  else
+  {
+    dma2d_convert((uint32_t)pstaged, 0, input_color_mode, Xaddress, Lcd_Ctx[Instance].XSize - Width, output_color_mode, Width, Height);
+  }
+
+  if(unstaged == 1U)
+  {
+    dma2d_fence();
   }
 #else
-  uint32_t color, j;
+  uint32_t color, i, j;
   for(i = 0; i < Height; i++)
   {
     for(j = 0; j < Width; j++)
@@ -1186,11 +1275,19 @@ int32_t BSP_LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32
   */
 int32_t BSP_LCD_ReadPixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t *Color)
 {
+  /* Wait for the queued DMA2D transfers to land in the frame buffer */
+  dma2d_fence();
+
   if(hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_ARGB8888)
   {
     /* Read data value from SDRAM memory */
     *Color = *(__IO uint32_t*) (hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + (4U*((Ypos*Lcd_Ctx[Instance].XSize) + Xpos)));
   }
+  else if(hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_L8)
+  {
+    /* Read the color index from SDRAM memory */
+    *Color = *(__IO uint8_t*) (hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + ((Ypos*Lcd_Ctx[Instance].XSize) + Xpos));
+  }
   else /* if((hlcd_ltdc.LayerCfg[layer].PixelFormat == LTDC_PIXEL_FORMAT_RGB565) */
   {
     /* Read data value from SDRAM memory */
@@ -1210,11 +1307,19 @@ int32_t BSP_LCD_ReadPixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint3
   */
 int32_t BSP_LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Color)
 {
+  /* Keep the CPU write ordered after the queued DMA2D transfers */
+  dma2d_fence();
+
   if(hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_ARGB8888)
   {
     /* Write data value to SDRAM memory */
     *(__IO uint32_t*) (hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + (4U*((Ypos*Lcd_Ctx[Instance].XSize) + Xpos))) = Color;
   }
+  else if(hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_L8)
+  {
+    /* Write the color index to SDRAM memory */
+    *(__IO uint8_t*) (hlcd_ltdc.LayerCfg[Lcd_Ctx[Instance].ActiveLayer].FBStartAdress + ((Ypos*Lcd_Ctx[Instance].XSize) + Xpos)) = (uint8_t)Color;
+  }
   else
   {
     /* Write data value to SDRAM memory */
@@ -1242,13 +1347,15 @@ int32_t BSP_LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint
   */
 static void LL_FillBuffer(uint32_t Instance, uint32_t *pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t Color)
 {
-  uint32_t output_color_mode, input_color = Color;
+  uint32_t output_color_mode;
 
   switch(Lcd_Ctx[Instance].PixelFormat)
   {
   case LCD_PIXEL_FORMAT_RGB565:
     output_color_mode = DMA2D_OUTPUT_RGB565; /* RGB565 */
-    input_color = CONVERTRGB5652ARGB8888(Color);
+    break;
+  case LCD_PIXEL_FORMAT_L8:
+    output_color_mode = DMA2D_FORMAT_L8; /* Color index, the queue splits the fill into transfers the DMA2D supports */
     break;
   case LCD_PIXEL_FORMAT_RGB888:
   default:
@@ -1256,22 +1363,8 @@ static void LL_FillBuffer(uint32_t Instance, uint32_t *pDst, uint32_t xSize, uin
     break;
   }
 
-  /* Register to memory mode with ARGB8888 as color Mode */
-  hlcd_dma2d.Init.Mode         = DMA2D_R2M;
-  hlcd_dma2d.Init.ColorMode    = output_color_mode;
-  hlcd_dma2d.Init.OutputOffset = OffLine;
-
-  hlcd_dma2d.Instance = DMA2D;
-
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hlcd_dma2d) == HAL_OK)
-  {
-      if (HAL_DMA2D_Start(&hlcd_dma2d, input_color, (uint32_t)pDst, xSize, ySize) == HAL_OK)
-      {
-        /* Polling For DMA transfer */
-      (void)HAL_DMA2D_PollForTransfer(&hlcd_dma2d, 50);
-    }
-  }
+  /* Register to memory mode, queued and completed by the DMA2D interrupt */
+  dma2d_fill((uint32_t)pDst, OffLine, output_color_mode, xSize, ySize, Color);
 }
 
 /**
@@ -1297,31 +1390,8 @@ static void LL_ConvertLineToRGB(uint32_t Instance, uint32_t *pSrc, uint32_t *pDs
     break;
   }
 
-  /* Configure the DMA2D Mode, Color Mode and output offset */
-  hlcd_dma2d.Init.Mode         = DMA2D_M2M_PFC;
-  hlcd_dma2d.Init.ColorMode    = output_color_mode;
-  hlcd_dma2d.Init.OutputOffset = 0;
-
-  /* Foreground Configuration */
-  hlcd_dma2d.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
-  hlcd_dma2d.LayerCfg[1].InputAlpha = 0xFF;
-  hlcd_dma2d.LayerCfg[1].InputColorMode = ColorMode;
-  hlcd_dma2d.LayerCfg[1].InputOffset = 0;
-
-  hlcd_dma2d.Instance = DMA2D;
-
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hlcd_dma2d) == HAL_OK)
-  {
-    if(HAL_DMA2D_ConfigLayer(&hlcd_dma2d, 1) == HAL_OK)
-    {
-      if (HAL_DMA2D_Start(&hlcd_dma2d, (uint32_t)pSrc, (uint32_t)pDst, xSize, 1) == HAL_OK)
-      {
-        /* Polling For DMA transfer */
-        (void)HAL_DMA2D_PollForTransfer(&hlcd_dma2d, 50);
-      }
-    }
-  }
+  /* Memory to memory with pixel format conversion, queued and completed by the DMA2D interrupt */
+  dma2d_convert((uint32_t)pSrc, 0, ColorMode, (uint32_t)pDst, 0, output_color_mode, xSize, 1);
 }
 
 /*******************************************************************************
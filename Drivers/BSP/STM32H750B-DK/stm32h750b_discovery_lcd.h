@@ -265,6 +265,8 @@ int32_t BSP_LCD_GetYSize(uint32_t Instance, uint32_t *YSize);
 lcd gfx utilities */
 int32_t BSP_LCD_SetActiveLayer(uint32_t Instance, uint32_t LayerIndex);
 int32_t BSP_LCD_GetPixelFormat(uint32_t Instance, uint32_t *PixelFormat);
+int32_t BSP_LCD_GetFrameBuffer(uint32_t Instance, LCD_UTILS_FrameBuffer_t *FrameBuffer);
+int32_t BSP_LCD_Sync(uint32_t Instance, uint32_t Ypos, uint32_t Height);
 int32_t BSP_LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pBmp);
 int32_t BSP_LCD_DrawHLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
 int32_t BSP_LCD_DrawVLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
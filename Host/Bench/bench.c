@@ -0,0 +1,176 @@
+/*
+ * bench.c
+ *
+ *  Timing harness shared by the host benchmarks
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "bench.h"
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static uint32_t result_count = 0;
+
+/// <summary>
+/// Two sided 95% quantile of the t distribution
+/// </summary>
+/// <param name="df">degrees of freedom</param>
+/// <returns>quantile</returns>
+static double t_quantile(uint32_t df) {
+    static const double table[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    return (df < sizeof(table) / sizeof(table[0])) ? table[df] : 1.96;
+}
+
+/// <summary>
+/// Allocates the next result, the last one is overwritten when the table is full
+/// </summary>
+/// <param name="name">of the benchmark</param>
+/// <returns>cleared result</returns>
+static bench_result_t* new_result(const char* name) {
+    bench_result_t* result = &results[result_count < BENCH_MAX_RESULTS - 1 ? result_count++ : result_count];
+    memset(result, 0, sizeof(*result));
+    result->name = name;
+    return result;
+}
+
+/// <summary>
+/// Gets the monotonic time
+/// </summary>
+/// <returns>time in nanoseconds</returns>
+uint64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/// <summary>
+/// Times the body over BENCH_SAMPLES samples after one warm up sample
+/// </summary>
+/// <param name="name">of the benchmark</param>
+/// <param name="body">performs operation i</param>
+/// <param name="iterations">operations per sample</param>
+/// <returns>result, counters can be attached to it</returns>
+bench_result_t* bench_run(const char* name, bench_body_t body, uint64_t iterations) {
+    double ns[BENCH_SAMPLES];
+    for (int32_t s = -1; s < BENCH_SAMPLES; ++s) {
+        const uint64_t start = bench_now_ns();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            body((size_t)i);
+        }
+        const uint64_t end = bench_now_ns();
+        if (s >= 0) {
+            ns[s] = (double)(end - start) / (double)iterations;
+        }
+    }
+
+    double mean = 0;
+    for (uint32_t s = 0; s < BENCH_SAMPLES; ++s) {
+        mean += ns[s];
+    }
+    mean /= BENCH_SAMPLES;
+    double variance = 0;
+    for (uint32_t s = 0; s < BENCH_SAMPLES; ++s) {
+        variance += (ns[s] - mean) * (ns[s] - mean);
+    }
+    variance /= BENCH_SAMPLES - 1;
+
+    bench_result_t* result = new_result(name);
+    result->iterations = iterations;
+    result->samples = BENCH_SAMPLES;
+    result->ns_per_op = mean;
+    result->stddev = sqrt(variance);
+    const double margin = t_quantile(BENCH_SAMPLES - 1) * result->stddev / sqrt(BENCH_SAMPLES);
+    result->ci_low = mean - margin;
+    result->ci_high = mean + margin;
+    return result;
+}
+
+/// <summary>
+/// Records a single measurement taken outside of bench_run, such as a share of a larger benchmark
+/// </summary>
+/// <param name="name">of the benchmark</param>
+/// <param name="ns_per_op">measured time</param>
+/// <param name="iterations">operations the time was averaged over</param>
+/// <returns>result, counters can be attached to it</returns>
+bench_result_t* bench_add(const char* name, double ns_per_op, uint64_t iterations) {
+    bench_result_t* result = new_result(name);
+    result->iterations = iterations;
+    result->samples = 1;
+    result->ns_per_op = ns_per_op;
+    result->ci_low = ns_per_op;
+    result->ci_high = ns_per_op;
+    return result;
+}
+
+/// <summary>
+/// Attaches a per operation counter to the result
+/// </summary>
+void bench_counter(bench_result_t* result, const char* name, double per_op) {
+    if (result->counter_count < BENCH_MAX_COUNTERS) {
+        result->counter_names[result->counter_count] = name;
+        result->counters[result->counter_count++] = per_op;
+    }
+}
+
+/// <summary>
+/// Prints the results as a table
+/// </summary>
+void bench_report(FILE* text) {
+    fprintf(text, "%-36s %12s %25s\n", "benchmark", "ns/op", "95% CI");
+    for (uint32_t i = 0; i < result_count; ++i) {
+        const bench_result_t* r = &results[i];
+        fprintf(text, "%-36s %12.2f [%10.2f, %10.2f]", r->name, r->ns_per_op, r->ci_low, r->ci_high);
+        for (uint32_t c = 0; c < r->counter_count; ++c) {
+            fprintf(text, "  %s=%.1f", r->counter_names[c], r->counters[c]);
+        }
+        fprintf(text, "\n");
+    }
+}
+
+/// <summary>
+/// Writes the results as JSON
+/// </summary>
+/// <param name="path">of the file</param>
+/// <param name="suite">name of the benchmark suite</param>
+/// <returns>0 on success</returns>
+int bench_write_json(const char* path, const char* suite) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(file, "{\n  \"suite\": \"%s\",\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n", suite);
+    for (uint32_t i = 0; i < result_count; ++i) {
+        const bench_result_t* r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"stddev\": %.3f, \"ci95\": [%.3f, %.3f], "
+            "\"samples\": %u, \"iterations\": %llu",
+            r->name, r->ns_per_op, r->stddev, r->ci_low, r->ci_high, r->samples, (unsigned long long)r->iterations);
+        if (r->counter_count != 0) {
+            fprintf(file, ", \"counters\": {");
+            for (uint32_t c = 0; c < r->counter_count; ++c) {
+                fprintf(file, "%s\"%s\": %.3f", c ? ", " : "", r->counter_names[c], r->counters[c]);
+            }
+            fprintf(file, "}");
+        }
+        fprintf(file, "}%s\n", (i + 1 < result_count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+/// <summary>
+/// Finds the --json argument
+/// </summary>
+/// <returns>path of the JSON output or NULL</returns>
+const char* bench_json_path(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) {
+            return argv[i + 1];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,41 @@
+/*
+ * bench.h
+ *
+ *  Timing harness shared by the host benchmarks
+ */
+
+#ifndef HOST_BENCH_BENCH_H_
+#define HOST_BENCH_BENCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define BENCH_SAMPLES 31
+#define BENCH_MAX_RESULTS 64
+#define BENCH_MAX_COUNTERS 4
+
+typedef struct {
+    const char* name;
+    uint64_t iterations; //operations per sample
+    uint32_t samples;
+    double ns_per_op; //mean over the samples
+    double stddev;
+    double ci_low; //95% confidence interval of the mean
+    double ci_high;
+    uint32_t counter_count;
+    const char* counter_names[BENCH_MAX_COUNTERS];
+    double counters[BENCH_MAX_COUNTERS]; //per operation
+} bench_result_t;
+
+typedef void (*bench_body_t)(size_t i);
+
+uint64_t bench_now_ns(void);
+bench_result_t* bench_run(const char* name, bench_body_t body, uint64_t iterations);
+bench_result_t* bench_add(const char* name, double ns_per_op, uint64_t iterations);
+void bench_counter(bench_result_t* result, const char* name, double per_op);
+void bench_report(FILE* text);
+int bench_write_json(const char* path, const char* suite);
+const char* bench_json_path(int argc, char** argv);
+
+#endif /* HOST_BENCH_BENCH_H_ */
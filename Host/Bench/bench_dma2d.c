@@ -0,0 +1,315 @@
+/*
+ * bench_dma2d.c
+ *
+ *  Checks the software DMA2D behind the command queue against a CPU reference: random overlapping fills, copies
+ *  and conversions, sources staged until the staging memory wraps around, retained sources and a full command ring
+ */
+#include "main.h"
+#include "bench.h"
+#include <string.h>
+
+extern RNG_HandleTypeDef rng;
+
+#define CANVAS_WIDTH 96
+#define CANVAS_HEIGHT 64
+#define N_CANVASES 3
+#define N_ROUNDS 4096
+#define MAX_ROUND_COMMANDS (3 * DMA2D_QUEUE_SIZE)
+#define MAX_STAGED_SIDE 40 //Up to 6400 bytes per staged ARGB8888 source, so the staging memory wraps often
+
+typedef struct {
+    uint32_t format;
+    uint32_t bpp;
+    uint8_t queued[CANVAS_WIDTH * CANVAS_HEIGHT * 4]; //Drawn through the queue
+    uint8_t reference[CANVAS_WIDTH * CANVAS_HEIGHT * 4]; //Drawn by the CPU when the command is queued
+} canvas_t;
+
+typedef struct {
+    uint32_t x, y, width, height;
+} rect_t;
+
+static canvas_t canvases[N_CANVASES] = {
+    { .format = DMA2D_FORMAT_ARGB8888, .bpp = 4 },
+    { .format = DMA2D_FORMAT_RGB565, .bpp = 2 },
+    { .format = DMA2D_FORMAT_L8, .bpp = 1 },
+};
+static uint8_t retained[CANVAS_WIDTH * CANVAS_HEIGHT * 4]; //ARGB8888 source that is never modified
+static uint8_t source[MAX_STAGED_SIDE * MAX_STAGED_SIDE * 4];
+static uint8_t source_copy[sizeof(source)];
+
+static uint32_t staged_sources = 0;
+static uint32_t staging_wraps = 0;
+static uint32_t retained_sources = 0;
+static uint32_t retained_passed = 0; //Retained sources that dma2d_stage passed through without a copy
+static uint32_t full_rings = 0;
+static uint32_t syncs_failed = 0; //Syncs after which the lines still differed from the reference
+
+static uint32_t next_random(void) {
+    uint32_t x;
+    HAL_RNG_GenerateRandomNumber(&rng, &x);
+    return x;
+}
+
+static uint32_t get_pixel(const uint8_t* p, uint32_t bpp) {
+    uint32_t c = 0;
+    for (uint32_t i = 0; i < bpp; ++i) {
+        c |= (uint32_t)p[i] << (8 * i);
+    }
+    return c;
+}
+
+static void set_pixel(uint8_t* p, uint32_t bpp, uint32_t c) {
+    for (uint32_t i = 0; i < bpp; ++i) {
+        p[i] = (uint8_t)(c >> (8 * i));
+    }
+}
+
+/// <summary>
+/// Converts a pixel channel by channel, RGB565 channels are widened by repeating their top bits like the DMA2D does
+/// </summary>
+/// <param name="c">pixel in the source format</param>
+/// <param name="src_format">format of the pixel</param>
+/// <param name="dst_format">format of the result, ARGB8888 or RGB565</param>
+/// <returns>the pixel in the destination format</returns>
+static uint32_t convert_pixel(uint32_t c, uint32_t src_format, uint32_t dst_format) {
+    uint32_t a = 0xff, r, g, b;
+    if (src_format == DMA2D_FORMAT_RGB565) {
+        const uint32_t r5 = c >> 11, g6 = (c >> 5) & 0x3f, b5 = c & 0x1f;
+        r = r5 * 8 + r5 / 4;
+        g = g6 * 4 + g6 / 16;
+        b = b5 * 8 + b5 / 4;
+    } else {
+        a = c >> 24;
+        r = (c >> 16) & 0xff;
+        g = (c >> 8) & 0xff;
+        b = c & 0xff;
+    }
+    if (dst_format == DMA2D_FORMAT_RGB565) {
+        return ((r / 8) << 11) | ((g / 4) << 5) | (b / 8);
+    }
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static rect_t random_rect(uint32_t max_side) {
+    rect_t rect;
+    rect.width = 1 + next_random() % max_side;
+    rect.height = 1 + next_random() % ((max_side < CANVAS_HEIGHT) ? max_side : CANVAS_HEIGHT);
+    rect.x = next_random() % (CANVAS_WIDTH - rect.width + 1);
+    rect.y = next_random() % (CANVAS_HEIGHT - rect.height + 1);
+    return rect;
+}
+
+static bool intersect(const rect_t* a, const rect_t* b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width && a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static uintptr_t pixel_address(canvas_t* canvas, uint32_t x, uint32_t y) {
+    return (uintptr_t)&canvas->queued[(y * CANVAS_WIDTH + x) * canvas->bpp];
+}
+
+/// <summary>
+/// Queues a fill and applies it to the reference, L8 fills take the path through RGB565 pixel pairs and staged
+/// columns
+/// </summary>
+/// <param name="canvas">destination</param>
+static void queue_fill(canvas_t* canvas) {
+    const rect_t rect = random_rect(CANVAS_WIDTH);
+    const uint32_t color = next_random() & ((canvas->bpp == 4) ? 0xffffffffU : (1U << (8 * canvas->bpp)) - 1);
+    dma2d_fill(pixel_address(canvas, rect.x, rect.y), CANVAS_WIDTH - rect.width, canvas->format, rect.width,
+        rect.height, color);
+    for (uint32_t y = rect.y; y < rect.y + rect.height; ++y) {
+        for (uint32_t x = rect.x; x < rect.x + rect.width; ++x) {
+            set_pixel(&canvas->reference[(y * CANVAS_WIDTH + x) * canvas->bpp], canvas->bpp, color);
+        }
+    }
+}
+
+/// <summary>
+/// Queues a copy between two disjoint rectangles of the canvas, the source usually holds pixels that earlier
+/// queued commands have not written yet
+/// </summary>
+/// <param name="canvas">source and destination</param>
+static void queue_copy(canvas_t* canvas) {
+    const rect_t src = random_rect(CANVAS_HEIGHT / 2);
+    rect_t dst;
+    do {
+        dst = random_rect(CANVAS_HEIGHT / 2);
+        dst.width = (src.width < CANVAS_WIDTH - dst.x) ? src.width : CANVAS_WIDTH - dst.x;
+        dst.height = (src.height < CANVAS_HEIGHT - dst.y) ? src.height : CANVAS_HEIGHT - dst.y;
+    } while (intersect(&src, &dst));
+    dma2d_copy(pixel_address(canvas, src.x, src.y), CANVAS_WIDTH - dst.width, pixel_address(canvas, dst.x, dst.y),
+        CANVAS_WIDTH - dst.width, canvas->format, dst.width, dst.height);
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        memcpy(&canvas->reference[((dst.y + y) * CANVAS_WIDTH + dst.x) * canvas->bpp],
+            &canvas->reference[((src.y + y) * CANVAS_WIDTH + src.x) * canvas->bpp], dst.width * canvas->bpp);
+    }
+}
+
+/// <summary>
+/// Queues a conversion between the ARGB8888 and the RGB565 canvas in either direction
+/// </summary>
+static void queue_convert(void) {
+    const bool to_rgb565 = next_random() & 1;
+    canvas_t* src = &canvases[to_rgb565 ? 0 : 1];
+    canvas_t* dst = &canvases[to_rgb565 ? 1 : 0];
+    const rect_t from = random_rect(CANVAS_HEIGHT);
+    const rect_t to = random_rect(CANVAS_HEIGHT);
+    const uint32_t width = (from.width < to.width) ? from.width : to.width;
+    const uint32_t height = (from.height < to.height) ? from.height : to.height;
+    dma2d_convert(pixel_address(src, from.x, from.y), CANVAS_WIDTH - width, src->format,
+        pixel_address(dst, to.x, to.y), CANVAS_WIDTH - width, dst->format, width, height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint32_t c = get_pixel(&src->reference[((from.y + y) * CANVAS_WIDTH + from.x + x) * src->bpp], src->bpp);
+            set_pixel(&dst->reference[((to.y + y) * CANVAS_WIDTH + to.x + x) * dst->bpp], dst->bpp,
+                convert_pixel(c, src->format, dst->format));
+        }
+    }
+}
+
+/// <summary>
+/// Queues a conversion from a source that is staged and then overwritten before the command runs, or from the
+/// retained image that must not be staged at all
+/// </summary>
+/// <param name="previous">staged address of the previous source, used to detect the wraparound</param>
+static void queue_staged(uintptr_t* previous) {
+    const bool from_retained = (next_random() % 4) == 0;
+    canvas_t* dst = &canvases[next_random() & 1];
+    const rect_t to = random_rect(MAX_STAGED_SIDE);
+    const uint32_t size = to.width * to.height * 4;
+    const uint8_t* pixels;
+    uintptr_t address;
+    if (from_retained) {
+        const uint32_t offset = (next_random() % (sizeof(retained) / 4 - to.width * to.height + 1)) * 4;
+        pixels = &retained[offset];
+        address = (uintptr_t)dma2d_stage(pixels, size);
+        ++retained_sources;
+        retained_passed += address == (uintptr_t)pixels;
+    } else {
+        for (uint32_t i = 0; i < size; ++i) {
+            source[i] = (uint8_t)next_random();
+        }
+        memcpy(source_copy, source, size);
+        address = (uintptr_t)dma2d_stage(source, size);
+        memset(source, 0xa5, size); //The staged copy has to be taken when the data is staged
+        pixels = source_copy;
+        ++staged_sources;
+        staging_wraps += address <= *previous;
+        *previous = address;
+    }
+    dma2d_convert(address, 0, DMA2D_FORMAT_ARGB8888, pixel_address(dst, to.x, to.y), CANVAS_WIDTH - to.width,
+        dst->format, to.width, to.height);
+    for (uint32_t y = 0; y < to.height; ++y) {
+        for (uint32_t x = 0; x < to.width; ++x) {
+            const uint32_t c = get_pixel(&pixels[(y * to.width + x) * 4], 4);
+            set_pixel(&dst->reference[((to.y + y) * CANVAS_WIDTH + to.x + x) * dst->bpp], dst->bpp,
+                convert_pixel(c, DMA2D_FORMAT_ARGB8888, dst->format));
+        }
+    }
+}
+
+/// <summary>
+/// Syncs random lines of a canvas, no queued command may still read or write them afterwards, so they already match
+/// the reference while the other commands are pending
+/// </summary>
+/// <param name="canvas">whose lines are synced</param>
+static void check_sync(canvas_t* canvas) {
+    const uint32_t y = next_random() % CANVAS_HEIGHT;
+    const uint32_t lines = 1 + next_random() % (CANVAS_HEIGHT - y);
+    const uint32_t pitch = CANVAS_WIDTH * canvas->bpp;
+    dma2d_sync((uintptr_t)&canvas->queued[y * pitch], lines * pitch);
+    syncs_failed += memcmp(&canvas->queued[y * pitch], &canvas->reference[y * pitch], lines * pitch) != 0;
+}
+
+/// <summary>
+/// Queues a round of random commands and compares the canvases with the reference after the fence
+/// </summary>
+/// <param name="round">number of the round, printed for the first differences</param>
+/// <returns>true if every canvas matches the reference</returns>
+static bool check_round(uint32_t round) {
+    const uint32_t commands = 1 + next_random() % MAX_ROUND_COMMANDS;
+    const uint32_t completed = dma2d_stats.commands;
+    uintptr_t previous = 0;
+    for (uint32_t i = 0; i < commands; ++i) {
+        switch (next_random() % 6) {
+            case 0:
+                queue_fill(&canvases[next_random() % N_CANVASES]);
+                break;
+            case 1:
+                queue_copy(&canvases[next_random() % N_CANVASES]);
+                break;
+            case 2:
+                queue_convert();
+                break;
+            case 3:
+                check_sync(&canvases[next_random() % N_CANVASES]);
+                break;
+            default:
+                queue_staged(&previous);
+                break;
+        }
+    }
+    dma2d_fence();
+    //The ring holds one command less than its size, more commands in a round have waited for a free slot
+    full_rings += dma2d_stats.commands - completed >= DMA2D_QUEUE_SIZE;
+
+    bool match = true;
+    for (uint32_t i = 0; i < N_CANVASES; ++i) {
+        if (memcmp(canvases[i].queued, canvases[i].reference, sizeof(canvases[i].queued)) != 0) {
+            if (match && round < 4) {
+                printf("round %u: canvas %u differs from the reference\n", round, i);
+            }
+            match = false;
+        }
+    }
+    return match;
+}
+
+static void bench_fill(size_t i) {
+    dma2d_fill(pixel_address(&canvases[0], 0, 0), 0, DMA2D_FORMAT_ARGB8888, CANVAS_WIDTH, CANVAS_HEIGHT, (uint32_t)i);
+    dma2d_fence();
+}
+
+static void bench_fill_l8(size_t i) {
+    dma2d_fill(pixel_address(&canvases[2], 1, 0), 1, DMA2D_FORMAT_L8, CANVAS_WIDTH - 1, CANVAS_HEIGHT, (uint32_t)i);
+    dma2d_fence();
+}
+
+static void bench_staged(size_t i) {
+    (void)i;
+    void* staged = dma2d_stage(source, MAX_STAGED_SIDE * MAX_STAGED_SIDE * 4);
+    dma2d_convert((uintptr_t)staged, 0, DMA2D_FORMAT_ARGB8888, pixel_address(&canvases[1], 0, 0),
+        CANVAS_WIDTH - MAX_STAGED_SIDE, DMA2D_FORMAT_RGB565, MAX_STAGED_SIDE, MAX_STAGED_SIDE);
+    dma2d_fence();
+}
+
+int main(int argc, char** argv) {
+    const char* json = bench_json_path(argc, argv);
+
+    dma2d_queue_init();
+    for (uint32_t i = 0; i < sizeof(retained); ++i) {
+        retained[i] = (uint8_t)next_random();
+    }
+    dma2d_retain((uintptr_t)retained, sizeof(retained));
+
+    uint32_t failed = 0;
+    for (uint32_t round = 0; round < N_ROUNDS; ++round) {
+        failed += !check_round(round);
+    }
+
+    bench_run("dma2d/fill/argb8888", bench_fill, 1 << 10);
+    bench_run("dma2d/fill/l8_odd", bench_fill_l8, 1 << 10);
+    bench_run("dma2d/staged_convert", bench_staged, 1 << 10);
+
+    bench_report(stdout);
+    printf("dma2d queue: %u of %u rounds differ from the reference, %u of %u syncs left a command on the lines\n",
+        failed, N_ROUNDS, syncs_failed, dma2d_stats.syncs);
+    printf("dma2d queue: %u staged sources, staging wrapped %u times, %u of %u retained sources used in place, "
+        "%u rounds filled the ring\n", staged_sources, staging_wraps, retained_passed, retained_sources, full_rings);
+    if (json != NULL && bench_write_json(json, "dma2d") != 0) {
+        return 1;
+    }
+    //Every case has to be exercised for the comparison to mean anything
+    const bool covered = staging_wraps != 0 && retained_sources != 0 && full_rings != 0;
+    return (failed == 0 && syncs_failed == 0 && covered && retained_passed == retained_sources) ? 0 : 1;
+}
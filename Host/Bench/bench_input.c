@@ -0,0 +1,372 @@
+/*
+ * bench_input.c
+ *
+ *  Input benchmarks: taps on the simulated panel raise the touch interrupt and are timed until their action is performed,
+ *  held buttons and gestures are replayed on a fixed clock and their events are checked against the exact expected times
+ */
+#include "main.h"
+#include "bench.h"
+
+#define TAP_BUTTONS 5 //The last button is play/pause, which would stop the game
+#define PLAY_PAUSE_BUTTON 5
+#define MS 1000000U //Host cycles per millisecond
+#define MAX_STEPS 8
+#define MAX_EVENTS 32
+#define FIELD -2 //Touch in the middle of the playing field
+#define FIELD_MOVED -3 //Touch on the playing field farther from its middle than a tap may move
+#define LIFT -1
+
+typedef struct {
+    uint32_t time; //Milliseconds from the start of the timeline
+    uint32_t finger;
+    int32_t button; //Button touched by the finger, FIELD or LIFT
+    uint32_t gesture; //Gesture recognized by the controller with this report
+} step_t;
+
+typedef struct {
+    const char* name;
+    step_t steps[MAX_STEPS];
+    uint32_t end;
+    input_event_t expected[MAX_EVENTS]; //Timestamps in milliseconds
+    input_mode_t mode;
+} timeline_t;
+
+#define TOUCH(t, f, b) { .time = (t), .finger = (f), .button = (b) }
+#define GESTURE(t, f, b, g) { .time = (t), .finger = (f), .button = (b), .gesture = (g) }
+#define PRESS(a, t) { .action = (a), .type = INPUT_PRESS, .timestamp = (t) }
+#define REPEAT(a, t) { .action = (a), .type = INPUT_REPEAT, .timestamp = (t) }
+#define RELEASE(a, t) { .action = (a), .type = INPUT_RELEASE, .timestamp = (t) }
+
+//Buttons 0 and 2 move left and right and repeat after 170 ms every 50 ms, button 1 rotates left and does not repeat
+static const timeline_t timelines[] = {
+    { .name = "hold left", .end = 600,
+        .steps = { TOUCH(0, 0, 0), TOUCH(500, 0, -1) },
+        .expected = { PRESS(MOVE_LEFT, 0), REPEAT(MOVE_LEFT, 170), REPEAT(MOVE_LEFT, 220), REPEAT(MOVE_LEFT, 270),
+            REPEAT(MOVE_LEFT, 320), REPEAT(MOVE_LEFT, 370), REPEAT(MOVE_LEFT, 420), REPEAT(MOVE_LEFT, 470),
+            RELEASE(MOVE_LEFT, 500) } },
+    { .name = "release before the delay", .end = 400,
+        .steps = { TOUCH(0, 0, 2), TOUCH(169, 0, -1) },
+        .expected = { PRESS(MOVE_RIGHT, 0), RELEASE(MOVE_RIGHT, 169) } },
+    { .name = "release on a repeat", .end = 400,
+        .steps = { TOUCH(0, 0, 2), TOUCH(220, 0, -1) },
+        .expected = { PRESS(MOVE_RIGHT, 0), REPEAT(MOVE_RIGHT, 170), REPEAT(MOVE_RIGHT, 220),
+            RELEASE(MOVE_RIGHT, 220) } },
+    { .name = "rotate while moving", .end = 400,
+        .steps = { TOUCH(0, 0, 0), TOUCH(100, 1, 1), TOUCH(120, 1, -1), TOUCH(300, 0, -1) },
+        .expected = { PRESS(MOVE_LEFT, 0), PRESS(ROTATE_LEFT, 100), RELEASE(ROTATE_LEFT, 120), REPEAT(MOVE_LEFT, 170),
+            REPEAT(MOVE_LEFT, 220), REPEAT(MOVE_LEFT, 270), RELEASE(MOVE_LEFT, 300) } },
+    { .name = "both moves held", .end = 400,
+        .steps = { TOUCH(0, 0, 0), TOUCH(30, 1, 2), TOUCH(250, 0, -1), TOUCH(260, 1, -1) },
+        .expected = { PRESS(MOVE_LEFT, 0), PRESS(MOVE_RIGHT, 30), REPEAT(MOVE_LEFT, 170), REPEAT(MOVE_RIGHT, 200),
+            REPEAT(MOVE_LEFT, 220), REPEAT(MOVE_RIGHT, 250), RELEASE(MOVE_LEFT, 250), RELEASE(MOVE_RIGHT, 260) } },
+    //The controller reports every 10 ms, the swipe is recognized once the finger travelled far enough
+    { .name = "swipe left", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, FIELD), TOUCH(10, 0, FIELD), TOUCH(20, 0, FIELD),
+            GESTURE(30, 0, FIELD, GESTURE_ID_MOVE_LEFT), TOUCH(40, 0, LIFT) },
+        .expected = { PRESS(MOVE_LEFT, 30) } },
+    { .name = "swipe down", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, FIELD), TOUCH(10, 0, FIELD), GESTURE(20, 0, FIELD, GESTURE_ID_MOVE_DOWN),
+            TOUCH(30, 0, FIELD), TOUCH(40, 0, LIFT) },
+        .expected = { PRESS(DROP, 20) } },
+    { .name = "tap on the field", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, FIELD), TOUCH(10, 0, FIELD), TOUCH(40, 0, LIFT) },
+        .expected = { PRESS(ROTATE_RIGHT, 40) } },
+    { .name = "button with gestures", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, 0), TOUCH(100, 0, LIFT) },
+        .expected = { PRESS(MOVE_LEFT, 0), RELEASE(MOVE_LEFT, 100) } },
+    //Holding play/pause switches to the gestures, the tap on the field afterwards rotates
+    { .name = "hold play/pause", .end = 1300,
+        .steps = { TOUCH(0, 0, PLAY_PAUSE_BUTTON), TOUCH(1100, 0, LIFT), TOUCH(1200, 0, FIELD), TOUCH(1210, 0, LIFT) },
+        .expected = { PRESS(PLAY_PAUSE, 0), RELEASE(PLAY_PAUSE, 1100), PRESS(ROTATE_RIGHT, 1210) } },
+    //Swipes without an action are dropped, the button press afterwards is the only event
+    { .name = "unrecognized swipe", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, FIELD), TOUCH(10, 0, FIELD_MOVED), TOUCH(40, 0, LIFT), TOUCH(60, 0, 1),
+            TOUCH(80, 0, LIFT) },
+        .expected = { PRESS(ROTATE_LEFT, 60), RELEASE(ROTATE_LEFT, 80) } },
+    { .name = "zoom", .end = 100, .mode = INPUT_MODE_GESTURES,
+        .steps = { TOUCH(0, 0, FIELD), GESTURE(10, 0, FIELD, GESTURE_ID_ZOOM_IN), TOUCH(40, 0, LIFT), TOUCH(60, 0, 1),
+            TOUCH(80, 0, LIFT) },
+        .expected = { PRESS(ROTATE_LEFT, 60), RELEASE(ROTATE_LEFT, 80) } }
+};
+
+static input_event_t recorded[MAX_EVENTS];
+static uint32_t recorded_count = 0;
+static bool recording = false;
+
+static input_event_t last_event; //Last press
+static uint64_t emitted = 0;
+static uint64_t released = 0;
+static uint64_t emit_latency_total = 0; //Touch interrupt to emitted action
+static uint64_t action_latency_total = 0; //Touch interrupt to performed action
+static uint32_t action_latency_max = 0;
+static volatile uint32_t sink;
+
+static void keep_event(const input_event_t* event) {
+    if (recording) {
+        if (recorded_count < MAX_EVENTS) {
+            recorded[recorded_count++] = *event;
+        }
+        return;
+    }
+    if (event->type == INPUT_RELEASE) {
+        ++released;
+        return;
+    }
+    emit_latency_total += DWT->CYCCNT - event->timestamp;
+    last_event = *event;
+    ++emitted;
+}
+
+static void reset_latencies(void) {
+    emitted = 0;
+    released = 0;
+    emit_latency_total = 0;
+    action_latency_total = 0;
+    action_latency_max = 0;
+}
+
+static void bench_scan_idle(size_t i) {
+    (void)i;
+    input_scan();
+    sink += input_touching();
+}
+
+static void bench_scan_held(size_t i) {
+    (void)i;
+    input_scan();
+    sink += input_touching();
+}
+
+static void bench_tap(size_t i) {
+    const button_t* btn = &buttons[i % TAP_BUTTONS];
+    host_ts_touch(0, btn->x + X_BTN / 2, btn->y + Y_BTN / 2);
+    input_scan();
+    host_ts_release(0);
+    input_scan();
+}
+
+static void bench_swipe(size_t i) {
+    host_ts_touch(0, LCD_DEFAULT_WIDTH / 2, LCD_DEFAULT_HEIGHT / 2);
+    input_scan();
+    host_ts_gesture(1 + i % 4);
+    host_ts_touch(0, LCD_DEFAULT_WIDTH / 2 + 20, LCD_DEFAULT_HEIGHT / 2);
+    input_scan();
+    host_ts_release(0);
+    input_scan();
+}
+
+/// <summary>
+/// Performs the last pressed action like the logic task does and records the time since the interrupt of the touch
+/// report that produced it
+/// </summary>
+static void perform_last_event(void) {
+    perform_action(last_event.action);
+    const uint32_t latency = DWT->CYCCNT - last_event.timestamp;
+    action_latency_total += latency;
+    action_latency_max = MAX(action_latency_max, latency);
+    input_performed(&last_event);
+    if (game_over) {
+        reset_game();
+    }
+}
+
+static void bench_touch_to_action(size_t i) {
+    const button_t* btn = &buttons[i % TAP_BUTTONS];
+    host_ts_touch(0, btn->x + X_BTN / 2, btn->y + Y_BTN / 2);
+    input_scan();
+    perform_last_event();
+    host_ts_release(0);
+    input_scan();
+}
+
+/// <summary>
+/// Swipes on the playing field, the report that carries the recognized gesture raises the interrupt the latency is
+/// measured from, like the press of a button
+/// </summary>
+static void bench_swipe_to_action(size_t i) {
+    host_ts_touch(0, LCD_DEFAULT_WIDTH / 2, LCD_DEFAULT_HEIGHT / 2);
+    input_scan();
+    host_ts_gesture(1 + i % 4);
+    host_ts_touch(0, LCD_DEFAULT_WIDTH / 2 + 20, LCD_DEFAULT_HEIGHT / 2);
+    input_scan();
+    perform_last_event();
+    host_ts_release(0);
+    input_scan();
+}
+
+/// <summary>
+/// Holds a move button with one finger while another finger taps a rotation button
+/// </summary>
+static void bench_chord(size_t i) {
+    const button_t* move = &buttons[(i & 1) ? 2 : 0];
+    const button_t* rotate = &buttons[(i & 2) ? 3 : 1];
+    host_ts_touch(0, move->x + X_BTN / 2, move->y + Y_BTN / 2);
+    input_scan();
+    host_ts_touch(1, rotate->x + X_BTN / 2, rotate->y + Y_BTN / 2);
+    input_scan();
+    host_ts_release(1);
+    input_scan();
+    host_ts_release(0);
+    input_scan();
+}
+
+/// <summary>
+/// Puts fingers on the first buttons and leaves them there
+/// </summary>
+/// <param name="count">fingers to put down</param>
+static void hold_fingers(uint32_t count) {
+    for (uint32_t f = 0; f < TS_TOUCH_NBR; ++f) {
+        if (f < count) {
+            host_ts_touch(f, buttons[f].x + X_BTN / 2, buttons[f].y + Y_BTN / 2);
+        } else {
+            host_ts_release(f);
+        }
+    }
+    input_scan();
+}
+
+/// <summary>
+/// Replays a timeline on the fixed clock, the repeat timer is modeled by emitting the repeats that are due before every
+/// step, and compares the events with the expected ones
+/// </summary>
+/// <param name="timeline">to replay</param>
+/// <returns>true if every event matches in order, action, type and time</returns>
+static bool replay_timeline(const timeline_t* timeline) {
+    const uint32_t start = 1000 * MS;
+    recorded_count = 0;
+    recording = true;
+    input_set_mode(timeline->mode);
+    for (size_t s = 0; s < MAX_STEPS && (s == 0 || timeline->steps[s].time != 0); ++s) {
+        const step_t* step = &timeline->steps[s];
+        const uint32_t now = start + step->time * MS;
+        input_repeat(now);
+        host_dwt_set(now);
+        if (step->button == LIFT) {
+            host_ts_release(step->finger);
+        } else if (step->button == FIELD) {
+            host_ts_touch(step->finger, LCD_DEFAULT_WIDTH / 2, LCD_DEFAULT_HEIGHT / 2);
+        } else if (step->button == FIELD_MOVED) {
+            host_ts_touch(step->finger, LCD_DEFAULT_WIDTH / 2 + 2 * INPUT_TAP_TRAVEL, LCD_DEFAULT_HEIGHT / 2);
+        } else {
+            const button_t* btn = &buttons[step->button];
+            host_ts_touch(step->finger, btn->x + X_BTN / 2, btn->y + Y_BTN / 2);
+        }
+        if (step->gesture != GESTURE_ID_NO_GESTURE) {
+            host_ts_gesture(step->gesture);
+        }
+        input_scan(); //On the target the release is read after the release timeout
+    }
+    input_repeat(start + timeline->end * MS);
+    recording = false;
+    input_set_mode(INPUT_MODE_BUTTONS);
+
+    size_t expected_count = 0;
+    while (expected_count < MAX_EVENTS && (expected_count == 0 || timeline->expected[expected_count].timestamp != 0)) {
+        ++expected_count;
+    }
+    bool match = recorded_count == expected_count;
+    for (size_t i = 0; i < recorded_count; ++i) {
+        const input_event_t* e = &timeline->expected[i];
+        const input_event_t* r = &recorded[i];
+        const bool same = i < expected_count && e->action == r->action && e->type == r->type &&
+            start + e->timestamp * MS == r->timestamp;
+        match = match && same;
+        if (!same) {
+            printf("%s: event %zu is action %d, type %d at %.3f ms\n", timeline->name, i, r->action, r->type,
+                (double)(r->timestamp - start) / MS);
+        }
+    }
+    if (recorded_count != expected_count) {
+        printf("%s: %u events instead of %zu\n", timeline->name, recorded_count, expected_count);
+    }
+    if (recorded_count != 0) {
+        printf("%-28s touch to first action %6.1f ms\n", timeline->name, (double)(recorded[0].timestamp - start) / MS);
+    }
+    return match;
+}
+
+int main(int argc, char** argv) {
+    const char* json = bench_json_path(argc, argv);
+    bench_result_t* result;
+
+    input_init(keep_event);
+    reset_game();
+
+    bench_run("input/scan/idle", bench_scan_idle, 1 << 18);
+    hold_fingers(1);
+    bench_run("input/scan/one_touch", bench_scan_held, 1 << 18);
+    hold_fingers(2);
+    bench_run("input/scan/two_touches", bench_scan_held, 1 << 18);
+    hold_fingers(0);
+
+    //The latencies are nanoseconds of the pipeline itself, the target adds the task wake up and the wait for the next frame
+    result = bench_run("input/tap", bench_tap, 1 << 16);
+    reset_latencies();
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        bench_tap(i);
+    }
+    bench_counter(result, "presses", (double)emitted / (1 << 16));
+    bench_counter(result, "releases", (double)released / (1 << 16));
+    bench_counter(result, "irq_to_emit_ns", (double)emit_latency_total / emitted);
+
+    result = bench_run("input/chord", bench_chord, 1 << 16);
+    reset_latencies();
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        bench_chord(i);
+    }
+    bench_counter(result, "presses", (double)emitted / (1 << 16));
+    bench_counter(result, "releases", (double)released / (1 << 16));
+
+    input_set_mode(INPUT_MODE_GESTURES);
+    result = bench_run("input/swipe", bench_swipe, 1 << 16);
+    reset_latencies();
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        bench_swipe(i);
+    }
+    bench_counter(result, "presses", (double)emitted / (1 << 16));
+    input_set_mode(INPUT_MODE_BUTTONS);
+
+    result = bench_run("input/touch_to_action", bench_touch_to_action, 1 << 16);
+    reset_latencies();
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        bench_touch_to_action(i);
+    }
+    bench_counter(result, "irq_to_emit_ns", (double)emit_latency_total / emitted);
+    bench_counter(result, "irq_to_action_ns", (double)action_latency_total / emitted);
+    bench_counter(result, "max_irq_to_action_ns", action_latency_max);
+    const double button_latency = (double)action_latency_total / emitted;
+
+    input_set_mode(INPUT_MODE_GESTURES);
+    result = bench_run("input/swipe_to_action", bench_swipe_to_action, 1 << 16);
+    reset_latencies();
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        bench_swipe_to_action(i);
+    }
+    bench_counter(result, "irq_to_emit_ns", (double)emit_latency_total / emitted);
+    bench_counter(result, "irq_to_action_ns", (double)action_latency_total / emitted);
+    bench_counter(result, "max_irq_to_action_ns", action_latency_max);
+    const double gesture_latency = (double)action_latency_total / emitted;
+    input_set_mode(INPUT_MODE_BUTTONS);
+
+    bench_report(stdout);
+    printf("irq to action: buttons %.1f ns, gestures %.1f ns, the gestures add %.1f ns\n", button_latency,
+        gesture_latency, gesture_latency - button_latency);
+
+    //Stops the host cycle counter, so it runs after the timed benchmarks. The first actions show how long the finger
+    //travels before a swipe or a tap is recognized, on the target a tap also waits for the release timeout
+    uint32_t matched = 0;
+    const uint32_t count = sizeof(timelines) / sizeof(timelines[0]);
+    for (uint32_t i = 0; i < count; ++i) {
+        matched += replay_timeline(&timelines[i]);
+    }
+    printf("input timelines: %u of %u match\n", matched, count);
+
+    printf("touch interrupts: %u, scans: %u, presses: %u, releases: %u, most touches: %u\n", input_stats.interrupts,
+        input_stats.scans, input_stats.actions, input_stats.releases, input_stats.max_touches);
+    printf("gestures: %u swipes, %u taps, %u dropped, %u switches of the controls\n", input_stats.swipes,
+        input_stats.taps, input_stats.dropped, input_stats.mode_switches);
+    if (json != NULL && bench_write_json(json, "input") != 0) {
+        return 1;
+    }
+    return (matched == count) ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+/*
+ * bench_logic.c
+ *
+ *  Micro-benchmarks of the game logic hot paths over recorded and randomized boards
+ */
+#include "tetris.c" //The hot paths are static
+#include "bench.h"
+
+#define N_BOARDS 256
+#define N_PIECES 4096 //power of two
+#define N_CHECK_PLACEMENTS (1 << 21)
+#define N_CHECK_QUERIES 4 //Random valid() queries before every placement
+
+typedef struct {
+    uint16_t rows[Y_DIM];
+    uint8_t colors[Y_DIM][X_DIM];
+} board_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t dir;
+    int8_t x;
+    int8_t y;
+} piece_t;
+
+static board_t recorded[N_BOARDS];
+static board_t randomized[N_BOARDS];
+static const board_t* boards;
+static piece_t pieces[N_PIECES];
+static piece_t placements[N_BOARDS][8]; //Spawn positions on every board
+static volatile uint32_t sink;
+
+//State of the per cell reference, the game state is kept in the globals of tetris.c
+static uint8_t reference_field[Y_DIM][X_DIM];
+static uint32_t reference_score;
+static uint32_t reference_lines_cleared;
+static uint32_t reference_level;
+static bool reference_over;
+
+static uint32_t next_random(void) {
+    uint32_t x;
+    HAL_RNG_GenerateRandomNumber(&rng, &x);
+    return x;
+}
+
+static void load_board(const board_t* board) {
+    memcpy(playing_field_rows, board->rows, sizeof(playing_field_rows));
+    memcpy(playing_field, board->colors, sizeof(playing_field));
+}
+
+static void save_board(board_t* board) {
+    memcpy(board->rows, playing_field_rows, sizeof(playing_field_rows));
+    memcpy(board->colors, playing_field, sizeof(playing_field));
+}
+
+/// <summary>
+/// Records the boards of games played by dropping pieces at random positions
+/// </summary>
+static void record_boards(void) {
+    size_t count = 0;
+    while (count < N_BOARDS) {
+        reset_game();
+        while (!game_over && count < N_BOARDS) {
+            const uint8_t dir = next_random() % 4;
+            const tetrimino_masks_t* masks = &tetrimino_masks[tetrimino.type][dir];
+            const int8_t x = -masks->left + next_random() % (X_DIM - masks->right + masks->left);
+            place_on_playing_field(tetrimino.type, dir, x, Y_DIM - masks->bottom);
+            clear_lines();
+            save_board(&recorded[count++]);
+            create_tetrimino(&tetrimino);
+        }
+    }
+}
+
+/// <summary>
+/// Generates boards with a random stack height, random holes and some full rows
+/// </summary>
+static void randomize_boards(void) {
+    for (size_t b = 0; b < N_BOARDS; ++b) {
+        const uint32_t height = next_random() % Y_DIM;
+        for (size_t y = 0; y < Y_DIM; ++y) {
+            uint16_t row = EMPTY_ROW;
+            if (y < height) {
+                row = (next_random() % 5 == 0) ? FULL_ROW : (EMPTY_ROW | ((next_random() & ((1 << X_DIM) - 1)) << X_WALL));
+            }
+            randomized[b].rows[y] = row;
+            for (size_t x = 0; x < X_DIM; ++x) {
+                randomized[b].colors[y][x] = (row & (1 << (x + X_WALL))) ? 1 + next_random() % 7 : 0;
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Generates pieces at random positions, valid or not
+/// </summary>
+static void generate_pieces(void) {
+    for (size_t i = 0; i < N_PIECES; ++i) {
+        pieces[i].type = 1 + next_random() % 7;
+        pieces[i].dir = next_random() % 4;
+        pieces[i].x = (int8_t)(next_random() % (X_DIM + 4)) - 2;
+        pieces[i].y = (int8_t)(next_random() % (Y_DIM + 2)) - 1;
+    }
+}
+
+/// <summary>
+/// Generates pieces in random orientations and columns at the spawn height, from where they are dropped
+/// </summary>
+static void generate_placements(void) {
+    for (size_t b = 0; b < N_BOARDS; ++b) {
+        for (size_t i = 0; i < 8; ++i) {
+            piece_t* p = &placements[b][i];
+            p->type = 1 + next_random() % 7;
+            p->dir = next_random() % 4;
+            const tetrimino_masks_t* masks = &tetrimino_masks[p->type][p->dir];
+            p->x = -masks->left + next_random() % (X_DIM - masks->right + masks->left);
+            p->y = Y_DIM - masks->bottom;
+        }
+    }
+}
+
+//Reverses the bit order of a tetrimino nibble so that bit n corresponds to column x + n
+static const uint8_t reversed_nibble[16] = { 0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF };
+
+/// <summary>
+/// Checks the position like valid() did before the mask table, by shifting every row of the shape into place
+/// </summary>
+/// <param name="type">of the tetrimino</param>
+/// <param name="dir">orientation of the tetrimino</param>
+/// <param name="x">position of the left bottom corner</param>
+/// <param name="y">position of the left bottom corner</param>
+/// <returns>true if the position is valid</returns>
+static bool shift_valid(uint8_t type, uint8_t dir, int8_t x, int8_t y) {
+    const uint16_t shape = tetriminos[type][dir];
+    if (x < -X_WALL || x >= X_DIM) {
+        return shape == 0;
+    }
+
+    for (int32_t i = 0; i < 4; ++i) {
+        if ((field_row(y + i) & (uint16_t)(reversed_nibble[(shape >> (i * 4)) & 0xf] << (x + X_WALL))) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Creates a 16bit 4x4 mask where 1 represents invalid fields, the per cell check the occupancy rows replaced
+/// </summary>
+/// <param name="x">position of the bottom left corner</param>
+/// <param name="y">position of the bottom left corner</param>
+/// <returns>mask</returns>
+static uint16_t reference_overlap_mask(int8_t x, int8_t y) {
+    uint16_t mask = 0;
+    for (int32_t i = 3; i >= 0; --i) {
+        for (int32_t j = 0; j < 4; ++j) {
+            mask = (mask << 1) | ((x + j < 0) || (y + i < 0) || (x + j >= X_DIM) || ((y + i < Y_DIM) && (reference_field[y + i][x + j] != 0)));
+        }
+    }
+    return mask;
+}
+
+//valid(), place_on_playing_field() and clear_lines() as they were before the occupancy rows, on the reference state
+static bool reference_valid(uint8_t type, uint8_t dir, int8_t x, int8_t y) {
+    return (reference_overlap_mask(x, y) & tetriminos[type][dir]) == 0;
+}
+
+static void reference_place(uint8_t type, uint8_t dir, int8_t x, int8_t y) {
+    uint32_t drop_count = 0;
+    while (reference_valid(type, dir, x, y - 1)) {
+        --y;
+        ++drop_count;
+    }
+
+    reference_score += 2 * drop_count;
+    const uint16_t shape = tetriminos[type][dir];
+    uint16_t mask = 1;
+    for (int32_t i = 0; i < 4; ++i) {
+        for (int32_t j = 3; j >= 0; --j) {
+            if ((mask & shape) != 0) {
+                if (x + j >= 0 && x + j < X_DIM && y + i >= 0 && y + i < Y_DIM) {
+                    reference_field[y + i][x + j] = type;
+                } else {
+                    reference_over = true;
+                }
+            }
+            mask <<= 1;
+        }
+    }
+}
+
+static void reference_clear_lines(void) {
+    bool full[Y_DIM];
+    for (size_t i = 0; i < Y_DIM; ++i) {
+        full[i] = true;
+        for (size_t j = 0; j < X_DIM; ++j) {
+            full[i] = full[i] && (reference_field[i][j] != 0);
+        }
+    }
+
+    size_t y = 0;
+    for (size_t i = 0; i < Y_DIM; ++i) {
+        if (!full[i]) {
+            if (i != y) {
+                memmove(reference_field[y++], reference_field[i], X_DIM * sizeof(uint8_t));
+            } else {
+                ++y;
+            }
+        }
+    }
+    for (size_t i = y; i < Y_DIM; ++i) {
+        memset(reference_field[i], 0, X_DIM * sizeof(uint8_t));
+    }
+
+    uint32_t count = 0;
+    for (size_t i = 0; i < Y_DIM; ++i) {
+        if (full[i]) {
+            ++count;
+            ++reference_lines_cleared;
+        } else {
+            reference_score += (reference_level + 1) * lines_score[count];
+            count = 0;
+        }
+    }
+    reference_level = MIN(reference_lines_cleared / LEVEL_THRESH, MAX_LEVEL);
+}
+
+/// <summary>
+/// Compares the game state with the reference, the occupancy rows have to match the cells of the reference
+/// </summary>
+/// <returns>true if they are the same</returns>
+static bool matches_reference(void) {
+    if (memcmp(playing_field, reference_field, sizeof(playing_field)) != 0 || score != reference_score ||
+        lines_cleared != reference_lines_cleared || level != reference_level || game_over != reference_over) {
+        return false;
+    }
+    for (size_t y = 0; y < Y_DIM; ++y) {
+        uint16_t row = EMPTY_ROW;
+        for (size_t x = 0; x < X_DIM; ++x) {
+            row |= (reference_field[y][x] != 0) ? (1 << (x + X_WALL)) : 0;
+        }
+        if (playing_field_rows[y] != row) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Plays random games with the occupancy rows and the per cell reference side by side, every placement is preceded
+/// by valid() queries at random positions, inside and outside of the walls
+/// </summary>
+/// <returns>number of placements and queries that differ from the reference</returns>
+static uint32_t check_logic(void) {
+    uint32_t mismatches = 0;
+    bool restart = true;
+    for (uint32_t n = 0; n < N_CHECK_PLACEMENTS; ++n) {
+        if (restart) {
+            reset_game();
+            memset(reference_field, 0, sizeof(reference_field));
+            reference_score = 0;
+            reference_lines_cleared = 0;
+            reference_level = 0;
+            reference_over = false;
+            restart = false;
+        }
+
+        for (uint32_t q = 0; q < N_CHECK_QUERIES; ++q) {
+            const uint8_t type = 1 + next_random() % 7, dir = next_random() % 4;
+            const int8_t x = (int8_t)(next_random() % (X_DIM + 8)) - 5;
+            const int8_t y = (int8_t)(next_random() % (Y_DIM + 8)) - 4;
+            mismatches += valid(type, dir, x, y) != reference_valid(type, dir, x, y);
+        }
+
+        const uint8_t type = 1 + next_random() % 7, dir = next_random() % 4;
+        const tetrimino_masks_t* masks = &tetrimino_masks[type][dir];
+        const int8_t x = -masks->left + next_random() % (X_DIM - masks->right + masks->left);
+        const int8_t y = Y_DIM - masks->bottom;
+        place_on_playing_field(type, dir, x, y);
+        clear_lines();
+        reference_place(type, dir, x, y);
+        reference_clear_lines();
+        if (!matches_reference()) {
+            ++mismatches;
+            restart = true; //The games went apart, comparing them further only repeats the mismatch
+        }
+        restart = restart || game_over;
+    }
+    return mismatches;
+}
+
+static void bench_valid(size_t i) {
+    if ((i & (N_PIECES - 1)) == 0) {
+        load_board(&boards[(i / N_PIECES) % N_BOARDS]);
+    }
+    const piece_t* p = &pieces[i & (N_PIECES - 1)];
+    sink += valid(p->type, p->dir, p->x, p->y);
+}
+
+static void bench_shift_valid(size_t i) {
+    if ((i & (N_PIECES - 1)) == 0) {
+        load_board(&boards[(i / N_PIECES) % N_BOARDS]);
+    }
+    const piece_t* p = &pieces[i & (N_PIECES - 1)];
+    sink += shift_valid(p->type, p->dir, p->x, p->y);
+}
+
+static void bench_restore(size_t i) {
+    load_board(&boards[i % N_BOARDS]);
+    sink += playing_field_rows[0];
+}
+
+static void bench_place(size_t i) {
+    load_board(&boards[i % N_BOARDS]);
+    const piece_t* p = &placements[i % N_BOARDS][(i / N_BOARDS) & 7];
+    place_on_playing_field(p->type, p->dir, p->x, p->y);
+    sink += playing_field_rows[0];
+}
+
+static void bench_clear_lines(size_t i) {
+    load_board(&boards[i % N_BOARDS]);
+    clear_lines();
+    sink += playing_field_rows[0];
+}
+
+static void bench_new_x_position(size_t i) {
+    sink += get_new_x_position(1 + i % 7);
+}
+
+/// <summary>
+/// Runs the benchmarks over one set of boards and prints the time the mask table saves per valid() call
+/// </summary>
+static void run_set(const board_t* set, const char* valid_name, const char* shift_name, const char* restore_name, const char* place_name, const char* clear_name) {
+    boards = set;
+    const bench_result_t* table = bench_run(valid_name, bench_valid, 1 << 20);
+    const bench_result_t* shift = bench_run(shift_name, bench_shift_valid, 1 << 20);
+    printf("mask table: %s %.2f [%.2f, %.2f] instead of %.2f [%.2f, %.2f] ns/op, %.2f ns saved per call\n", valid_name,
+        table->ns_per_op, table->ci_low, table->ci_high, shift->ns_per_op, shift->ci_low, shift->ci_high,
+        shift->ns_per_op - table->ns_per_op);
+    bench_run(restore_name, bench_restore, 1 << 18);
+    bench_run(place_name, bench_place, 1 << 18);
+    bench_run(clear_name, bench_clear_lines, 1 << 18);
+}
+
+int main(int argc, char** argv) {
+    const char* json = bench_json_path(argc, argv);
+
+    record_boards();
+    randomize_boards();
+    generate_pieces();
+    generate_placements();
+
+    //The place and clear benchmarks restore the board before every operation, the restore line is their baseline
+    run_set(recorded, "valid/recorded", "valid/shift/recorded", "restore/recorded", "place+restore/recorded", "clear_lines+restore/recorded");
+    run_set(randomized, "valid/randomized", "valid/shift/randomized", "restore/randomized", "place+restore/randomized", "clear_lines+restore/randomized");
+    bench_run("get_new_x_position", bench_new_x_position, 1 << 20);
+
+    const uint32_t mismatches = check_logic();
+
+    bench_report(stdout);
+    printf("occupancy rows: %u of %u placements and queries differ from the per cell reference\n", mismatches,
+        N_CHECK_PLACEMENTS * (N_CHECK_QUERIES + 1));
+    if (json != NULL && bench_write_json(json, "logic") != 0) {
+        return 1;
+    }
+    return (mismatches == 0) ? 0 : 1;
+}
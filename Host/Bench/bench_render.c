@@ -0,0 +1,818 @@
+/*
+ * bench_render.c
+ *
+ *  Rendering benchmarks: the cost of every drawing primitive and of whole frames broken down by primitive
+ */
+#include "main.h"
+#include "bench.h"
+
+#define N_POLYGONS 7
+#define N_RANDOM_POLYGONS 256
+#define MAX_RANDOM_POINTS 12
+#define N_REPLAY 512 //Recorded frames, even so that every frame is always drawn into the same buffer
+#define FRAME_TICKS 2
+#define HUD_TEXT "Score: 123456, Level: 12"
+
+typedef enum {
+    PRIM_FILL_RECT,
+    PRIM_DRAW_RECT,
+    PRIM_DRAW_POLYGON,
+    PRIM_DISPLAY_STRING,
+    PRIM_CLEAR,
+    PRIM_SPRITE,
+    PRIM_LABEL,
+    PRIM_OTHER, //Composing and comparing the frames and the driver calls made outside of the primitives above
+    N_PRIMS
+} primitive_t;
+
+typedef struct {
+    uint64_t invocations;
+    uint64_t calls; //Driver calls
+    uint64_t pixels; //Pixels written or read by the driver
+    uint64_t ns;
+} usage_t;
+
+static const char* const primitive_names[N_PRIMS] = {
+    "FillRect", "DrawRect", "DrawPolygon", "DisplayStringAt", "Clear", "sprite_draw", "label_draw", "other"
+};
+
+static usage_t usage[N_PRIMS];
+static primitive_t current = PRIM_OTHER;
+static bool profiling = false;
+static bool direct = true; //Whether the frame buffer is handed to the drawing functions
+
+/// <summary>
+/// Starts attributing the driver calls and the time to a primitive, nested primitives are attributed to the outer one
+/// </summary>
+/// <param name="primitive">that is starting</param>
+/// <returns>start time</returns>
+static uint64_t begin_primitive(primitive_t primitive) {
+    if (!profiling || current != PRIM_OTHER) {
+        return 0;
+    }
+    current = primitive;
+    return bench_now_ns();
+}
+
+/// <summary>
+/// Stops attributing to the primitive once its transfers have completed
+/// </summary>
+/// <param name="primitive">that has finished</param>
+/// <param name="start">time returned by begin_primitive</param>
+static void end_primitive(primitive_t primitive, uint64_t start) {
+    if (profiling && current == primitive) {
+        dma2d_fence();
+        usage[primitive].ns += bench_now_ns() - start;
+        ++usage[primitive].invocations;
+        current = PRIM_OTHER;
+    }
+}
+
+static void profiled_fill_rect(uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color) {
+    const uint64_t start = begin_primitive(PRIM_FILL_RECT);
+    UTIL_LCD_FillRect(Xpos, Ypos, Width, Height, Color);
+    end_primitive(PRIM_FILL_RECT, start);
+}
+
+static void profiled_draw_rect(uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color) {
+    const uint64_t start = begin_primitive(PRIM_DRAW_RECT);
+    UTIL_LCD_DrawRect(Xpos, Ypos, Width, Height, Color);
+    end_primitive(PRIM_DRAW_RECT, start);
+}
+
+static void profiled_draw_polygon(pPoint Points, uint32_t PointCount, uint32_t Color) {
+    const uint64_t start = begin_primitive(PRIM_DRAW_POLYGON);
+    UTIL_LCD_DrawPolygon(Points, PointCount, Color);
+    end_primitive(PRIM_DRAW_POLYGON, start);
+}
+
+static void profiled_display_string_at(uint32_t Xpos, uint32_t Ypos, uint8_t* Text, Text_AlignModeTypdef Mode) {
+    const uint64_t start = begin_primitive(PRIM_DISPLAY_STRING);
+    UTIL_LCD_DisplayStringAt(Xpos, Ypos, Text, Mode);
+    end_primitive(PRIM_DISPLAY_STRING, start);
+}
+
+static void profiled_clear(uint32_t Color) {
+    const uint64_t start = begin_primitive(PRIM_CLEAR);
+    UTIL_LCD_Clear(Color);
+    end_primitive(PRIM_CLEAR, start);
+}
+
+static void profiled_sprite_draw(const sprite_t* sprite, uint16_t x, uint16_t y) {
+    const uint64_t start = begin_primitive(PRIM_SPRITE);
+    sprite_draw(sprite, x, y);
+    end_primitive(PRIM_SPRITE, start);
+}
+
+static void profiled_label_draw(const label_t* label, const label_state_t* previous) {
+    const uint64_t start = begin_primitive(PRIM_LABEL);
+    label_draw(label, previous);
+    end_primitive(PRIM_LABEL, start);
+}
+
+//The game is compiled into this file with its drawing calls routed through the wrappers above
+#define UTIL_LCD_FillRect profiled_fill_rect
+#define UTIL_LCD_DrawRect profiled_draw_rect
+#define UTIL_LCD_DrawPolygon profiled_draw_polygon
+#define UTIL_LCD_DisplayStringAt profiled_display_string_at
+#define UTIL_LCD_Clear profiled_clear
+#define sprite_draw profiled_sprite_draw
+#define label_draw profiled_label_draw
+#include "tetris.c"
+#undef UTIL_LCD_FillRect
+#undef UTIL_LCD_DrawRect
+#undef UTIL_LCD_DrawPolygon
+#undef UTIL_LCD_DisplayStringAt
+#undef UTIL_LCD_Clear
+#undef sprite_draw
+#undef label_draw
+
+static int32_t count_fill_rgb_rect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t* pData, uint32_t Width, uint32_t Height) {
+    ++usage[current].calls;
+    usage[current].pixels += Width * Height;
+    return BSP_LCD_FillRGBRect(Instance, Xpos, Ypos, pData, Width, Height);
+}
+
+static int32_t count_draw_hline(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color) {
+    ++usage[current].calls;
+    usage[current].pixels += Length;
+    return BSP_LCD_DrawHLine(Instance, Xpos, Ypos, Length, Color);
+}
+
+static int32_t count_draw_vline(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color) {
+    ++usage[current].calls;
+    usage[current].pixels += Length;
+    return BSP_LCD_DrawVLine(Instance, Xpos, Ypos, Length, Color);
+}
+
+static int32_t count_fill_rect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color) {
+    ++usage[current].calls;
+    usage[current].pixels += Width * Height;
+    return BSP_LCD_FillRect(Instance, Xpos, Ypos, Width, Height, Color);
+}
+
+static int32_t count_read_pixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t* Color) {
+    ++usage[current].calls;
+    ++usage[current].pixels;
+    return BSP_LCD_ReadPixel(Instance, Xpos, Ypos, Color);
+}
+
+static int32_t count_write_pixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Color) {
+    ++usage[current].calls;
+    ++usage[current].pixels;
+    return BSP_LCD_WritePixel(Instance, Xpos, Ypos, Color);
+}
+
+//Pixels written directly into the frame buffer would not be seen by the driver, so the frame buffer is not handed out
+//while counting and every pixel is counted as a driver call
+static int32_t count_get_frame_buffer(uint32_t Instance, LCD_UTILS_FrameBuffer_t* FrameBuffer) {
+    (void)Instance;
+    (void)FrameBuffer;
+    return -1;
+}
+
+//Counts the calls and the pixels of every drawing entry before passing them on to the host frame buffers
+static const LCD_UTILS_Drv_t counting_driver = {
+    BSP_LCD_DrawBitmap,
+    count_fill_rgb_rect,
+    count_draw_hline,
+    count_draw_vline,
+    count_fill_rect,
+    count_read_pixel,
+    count_write_pixel,
+    BSP_LCD_GetXSize,
+    BSP_LCD_GetYSize,
+    BSP_LCD_SetActiveLayer,
+    BSP_LCD_GetPixelFormat,
+    count_get_frame_buffer,
+    BSP_LCD_Sync
+};
+
+static snapshot_t replay[N_REPLAY];
+static const action_t random_actions[] = { MOVE_LEFT, MOVE_RIGHT, ROTATE_LEFT, ROTATE_RIGHT, DROP };
+
+/// <summary>
+/// Records the snapshot of every frame of a game played like the host loop plays it
+/// </summary>
+static void record_replay(void) {
+    uint32_t action_seed = 12345;
+    reset_game();
+    for (size_t frame = 0; frame < N_REPLAY; ++frame) {
+        for (uint32_t i = 0; i < FRAME_TICKS; ++i) {
+            tick();
+        }
+        if (frame % 4 == 0) {
+            action_seed = action_seed * 1103515245 + 12345;
+            perform_action(random_actions[(action_seed >> 16) % (sizeof(random_actions) / sizeof(random_actions[0]))]);
+        }
+        if (game_over) {
+            perform_action(RESET_GAME);
+        }
+        update_state();
+        clear_lines();
+        take_snapshot(&replay[frame]);
+    }
+}
+
+static inline uint32_t cell_x(size_t i) {
+    return X_START + (i % X_DIM) * X_BOX;
+}
+
+static inline uint32_t cell_y(size_t i) {
+    return Y_START - ((i / X_DIM) % Y_DIM) * Y_BOX;
+}
+
+static void bench_fill_rect(size_t i) {
+    UTIL_LCD_FillRect(cell_x(i), cell_y(i), X_BOX, Y_BOX, colors[1 + i % 7]);
+    dma2d_fence();
+}
+
+static void bench_draw_rect(size_t i) {
+    UTIL_LCD_DrawRect(cell_x(i), cell_y(i), X_BOX, Y_BOX, UTIL_LCD_COLOR_GRAY);
+    dma2d_fence();
+}
+
+static void bench_draw_polygon(size_t i) {
+    UTIL_LCD_DrawPolygon(polygons[i % N_POLYGONS], polygon_sizes[i % N_POLYGONS], UTIL_LCD_COLOR_WHITE);
+    dma2d_fence();
+}
+
+/// <summary>
+/// Draws a line one pixel at a time, the way UTIL_LCD_DrawLine did before it merged pixels into runs
+/// </summary>
+/// <param name="x1">of the first point</param>
+/// <param name="y1">of the first point</param>
+/// <param name="x2">of the second point</param>
+/// <param name="y2">of the second point</param>
+/// <param name="color">of the line</param>
+static void per_pixel_line(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+    const int32_t dx = abs(x2 - x1), dy = abs(y2 - y1);
+    const int32_t sx = (x2 >= x1) ? 1 : -1, sy = (y2 >= y1) ? 1 : -1;
+    const bool x_major = dx >= dy;
+    const int32_t den = x_major ? dx : dy, add = x_major ? dy : dx;
+    int32_t num = den / 2, x = x1, y = y1;
+    for (int32_t i = 0; i <= den; ++i) {
+        UTIL_LCD_SetPixel(x, y, color);
+        num += add;
+        if (num >= den) {
+            num -= den;
+            x += x_major ? 0 : sx;
+            y += x_major ? sy : 0;
+        }
+        x += x_major ? sx : 0;
+        y += x_major ? 0 : sy;
+    }
+}
+
+/// <summary>
+/// Draws the outline of a polygon with per_pixel_line in the order of UTIL_LCD_DrawPolygon
+/// </summary>
+/// <param name="points">of the polygon</param>
+/// <param name="count">number of points</param>
+/// <param name="color">of the outline</param>
+static void per_pixel_polygon(const Point* points, uint32_t count, uint32_t color) {
+    per_pixel_line(points[0].X, points[0].Y, points[count - 1].X, points[count - 1].Y, color);
+    for (uint32_t p = 1; p < count; ++p) {
+        per_pixel_line(points[p - 1].X, points[p - 1].Y, points[p].X, points[p].Y, color);
+    }
+}
+
+static void bench_draw_polygon_per_pixel(size_t i) {
+    per_pixel_polygon(polygons[i % N_POLYGONS], polygon_sizes[i % N_POLYGONS], UTIL_LCD_COLOR_WHITE);
+}
+
+static void bench_display_string_at(size_t i) {
+    UTIL_LCD_DisplayStringAt(4, 10 + (i % 8) * 16, (uint8_t*)HUD_TEXT, LEFT_MODE);
+    dma2d_fence();
+}
+
+//Every call draws in a text color of its own, so every glyph misses the cache and evicts the least recently used one
+static void bench_display_string_at_miss(size_t i) {
+    UTIL_LCD_SetTextColor(0xFF000000U | (uint32_t)(i + 1));
+    UTIL_LCD_DisplayStringAt(4, 10 + (i % 8) * 16, (uint8_t*)HUD_TEXT, LEFT_MODE);
+    dma2d_fence();
+}
+
+static void bench_fill_polygon(size_t i) {
+    UTIL_LCD_FillPolygon(polygons[i % N_POLYGONS], polygon_sizes[i % N_POLYGONS], UTIL_LCD_COLOR_WHITE);
+    dma2d_fence();
+}
+
+static void bench_fill_circle(size_t i) {
+    UTIL_LCD_FillCircle(40 + (i % 400), LCD_DEFAULT_HEIGHT / 2, 10, colors[1 + i % 7]);
+    dma2d_fence();
+}
+
+//A fill of half the screen is queued before box outlines are written directly, on the other half or on the same half
+static void bench_sync_disjoint(size_t i) {
+    UTIL_LCD_FillRect(0, 0, LCD_DEFAULT_WIDTH, LCD_DEFAULT_HEIGHT / 2, UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_DrawRect(40 + (i % 400), LCD_DEFAULT_HEIGHT / 2 + 40, X_BOX, Y_BOX, UTIL_LCD_COLOR_GRAY);
+    dma2d_fence();
+}
+
+static void bench_sync_overlap(size_t i) {
+    UTIL_LCD_FillRect(0, LCD_DEFAULT_HEIGHT / 2, LCD_DEFAULT_WIDTH, LCD_DEFAULT_HEIGHT / 2, UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_DrawRect(40 + (i % 400), LCD_DEFAULT_HEIGHT / 2 + 40, X_BOX, Y_BOX, UTIL_LCD_COLOR_GRAY);
+    dma2d_fence();
+}
+
+static void bench_clear(size_t i) {
+    (void)i;
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    dma2d_fence();
+}
+
+static void bench_render_replay(size_t i) {
+    host_lcd_select(i & 1);
+    render(i & 1, &replay[i % N_REPLAY]);
+    dma2d_fence();
+}
+
+static void bench_render_full(size_t i) {
+    frames[i & 1].valid = false;
+    host_lcd_select(i & 1);
+    render(i & 1, &replay[i % N_REPLAY]);
+    dma2d_fence();
+}
+
+//A full frame that also redraws the background layer, one clear more than a single layer frame used to draw
+static void bench_render_full_one_layer(size_t i) {
+    frames[i & 1].valid = false;
+    background_drawn = false;
+    host_lcd_select(i & 1);
+    render(i & 1, &replay[i % N_REPLAY]);
+    dma2d_fence();
+}
+
+/// <summary>
+/// Swaps the driver, which also resets the active layer, and goes back to drawing the foreground
+/// </summary>
+/// <param name="driver">to draw through</param>
+static void use_driver(const LCD_UTILS_Drv_t* driver) {
+    LCD_UTILS_Drv_t used = *driver;
+    if (!direct) {
+        used.GetFrameBuffer = NULL;
+        used.Sync = NULL;
+    }
+    UTIL_LCD_SetFuncDriver(&used);
+    UTIL_LCD_SetLayer(FOREGROUND_LAYER);
+}
+
+/// <summary>
+/// Chooses between writing pixels and short lines directly into the frame buffer and passing every one to the driver
+/// </summary>
+/// <param name="enabled">true for the direct writes</param>
+static void use_direct(bool enabled) {
+    direct = enabled;
+    use_driver(&LCD_Driver);
+}
+
+/// <summary>
+/// Runs the body through the counting driver and attaches the driver calls and pixels per operation to the result
+/// </summary>
+/// <param name="result">of the timed run</param>
+/// <param name="body">performs operation i</param>
+/// <param name="iterations">operations to count over</param>
+static void count(bench_result_t* result, bench_body_t body, uint64_t iterations) {
+    memset(usage, 0, sizeof(usage));
+    use_driver(&counting_driver);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body((size_t)i);
+    }
+    use_driver(&LCD_Driver);
+
+    uint64_t calls = 0, pixels = 0;
+    for (size_t p = 0; p < N_PRIMS; ++p) {
+        calls += usage[p].calls;
+        pixels += usage[p].pixels;
+    }
+    bench_counter(result, "calls", (double)calls / iterations);
+    bench_counter(result, "pixels", (double)pixels / iterations);
+}
+
+/// <summary>
+/// Times and counts one primitive
+/// </summary>
+/// <returns>result with the calls and the pixels per operation as its first two counters</returns>
+static bench_result_t* run_primitive(const char* name, bench_body_t body, uint64_t iterations) {
+    bench_result_t* result = bench_run(name, body, iterations);
+    count(result, body, iterations);
+    return result;
+}
+
+/// <summary>
+/// Times the body with the direct writes and attaches how many of its syncs had to wait for a queued DMA2D command
+/// </summary>
+/// <returns>result with the syncs and the waiting syncs per operation as its first two counters</returns>
+static bench_result_t* run_sync(const char* name, bench_body_t body, uint64_t iterations) {
+    bench_result_t* result = bench_run(name, body, iterations);
+    memset(&dma2d_stats, 0, sizeof(dma2d_stats));
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body((size_t)i);
+    }
+    bench_counter(result, "syncs", (double)dma2d_stats.syncs / iterations);
+    bench_counter(result, "sync_waits", (double)dma2d_stats.sync_waits / iterations);
+    return result;
+}
+
+/// <summary>
+/// Times a text primitive and attaches how many of its glyphs were drawn from the cache and how many were expanded
+/// </summary>
+/// <returns>result with the hits and the misses per operation as its first two counters</returns>
+static bench_result_t* run_glyphs(const char* name, bench_body_t body, uint64_t iterations) {
+    uint32_t hits, misses, start_hits, start_misses;
+    bench_result_t* result = bench_run(name, body, iterations);
+    UTIL_LCD_GetGlyphCacheStats(&start_hits, &start_misses);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body((size_t)i);
+    }
+    UTIL_LCD_GetGlyphCacheStats(&hits, &misses);
+    bench_counter(result, "hits", (double)(hits - start_hits) / iterations);
+    bench_counter(result, "misses", (double)(misses - start_misses) / iterations);
+    return result;
+}
+
+/// <summary>
+/// Renders every recorded frame once with the primitives profiled and records the share of every primitive, the
+/// time of the driver calls made outside of the primitives is what remains of the frame time
+/// </summary>
+/// <param name="body">renders frame i</param>
+/// <param name="names">of the results, one per primitive</param>
+static void profile_frames(bench_body_t body, char names[N_PRIMS][48]) {
+    memset(usage, 0, sizeof(usage));
+    use_driver(&counting_driver);
+    profiling = true;
+    const uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < N_REPLAY; ++i) {
+        body(i);
+    }
+    const uint64_t total = bench_now_ns() - start;
+    profiling = false;
+    use_driver(&LCD_Driver);
+
+    uint64_t attributed = 0;
+    for (size_t p = 0; p < PRIM_OTHER; ++p) {
+        attributed += usage[p].ns;
+    }
+    usage[PRIM_OTHER].ns = total - attributed;
+    usage[PRIM_OTHER].invocations = N_REPLAY;
+
+    for (size_t p = 0; p < N_PRIMS; ++p) {
+        if (usage[p].invocations == 0 && usage[p].calls == 0) {
+            continue;
+        }
+        bench_result_t* result = bench_add(names[p], (double)usage[p].ns / N_REPLAY, N_REPLAY);
+        bench_counter(result, "invocations", (double)usage[p].invocations / N_REPLAY);
+        bench_counter(result, "calls", (double)usage[p].calls / N_REPLAY);
+        bench_counter(result, "pixels", (double)usage[p].pixels / N_REPLAY);
+        bench_counter(result, "share", 100.0 * usage[p].ns / total);
+    }
+}
+
+/// <summary>
+/// Switches the frame buffers to the pixel format, the sprites, the labels and the background are drawn again in it
+/// </summary>
+/// <param name="format">LCD_PIXEL_FORMAT_ARGB8888, LCD_PIXEL_FORMAT_RGB565 or LCD_PIXEL_FORMAT_L8</param>
+static void use_format(uint32_t format) {
+    host_config(format);
+    time_label.version = 0;
+    score_label.version = 0;
+    background_drawn = false;
+    frames[0].valid = false;
+    frames[1].valid = false;
+}
+
+/// <summary>
+/// Gets the size of a pixel in the frame buffers and the background
+/// </summary>
+/// <param name="format">LCD_PIXEL_FORMAT_ARGB8888, LCD_PIXEL_FORMAT_RGB565 or LCD_PIXEL_FORMAT_L8</param>
+/// <returns>bytes per pixel</returns>
+static double bytes_per_pixel(uint32_t format) {
+    return (format == LCD_PIXEL_FORMAT_RGB565) ? 2.0 : (format == LCD_PIXEL_FORMAT_L8) ? 1.0 : 4.0;
+}
+
+/// <summary>
+/// Gets the bandwidth the LTDC needs to scan out one full screen layer
+/// </summary>
+/// <param name="format">of the layer</param>
+/// <returns>MB/s at the refresh rate of the display</returns>
+static double layer_scanout_mb_s(uint32_t format) {
+    const double bytes = LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT * bytes_per_pixel(format);
+    return bytes * (1000000.0 / vsync_stats.refresh_us) / (1024.0 * 1024.0);
+}
+
+/// <summary>
+/// Plays the replay in both frame buffer formats, attaches the DMA2D busy time and traffic per frame and the bandwidth
+/// the LTDC needs to scan out both layers
+/// </summary>
+/// <param name=""></param>
+static void compare_formats(void) {
+    static const uint32_t formats[] = { LCD_PIXEL_FORMAT_ARGB8888, LCD_PIXEL_FORMAT_RGB565, LCD_PIXEL_FORMAT_L8 };
+    static const char* const names[] = { "format/argb8888", "format/rgb565", "format/l8" };
+    vsync_init();
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+        use_format(formats[f]);
+        bench_result_t* result = bench_run(names[f], bench_render_replay, N_REPLAY);
+
+        //One more pass for the statistics, drawn from a clean start like the timed passes
+        use_format(formats[f]);
+        memset(&dma2d_stats, 0, sizeof(dma2d_stats));
+        for (size_t i = 0; i < N_REPLAY; ++i) {
+            bench_render_replay(i);
+        }
+        bench_counter(result, "dma2d_commands", (double)dma2d_stats.commands / N_REPLAY);
+        bench_counter(result, "dma2d_busy_us", (double)dma2d_stats.busy_cycles / N_REPLAY / 1000.0);
+        bench_counter(result, "dma2d_kb", (double)dma2d_stats.bytes / N_REPLAY / 1024.0);
+        bench_counter(result, "ltdc_mb_s", 2.0 * layer_scanout_mb_s(formats[f]));
+    }
+    use_format(LCD_FRAME_FORMAT);
+}
+
+/// <summary>
+/// Plays the replay with the boxes blitted from their tiles or painted from a fill and an outline, and attaches the
+/// DMA2D commands per frame
+/// </summary>
+/// <param name="name">of the result</param>
+/// <param name="tiles">false to paint the boxes like before the tiles</param>
+/// <returns>result with the calls, the pixels and the DMA2D commands per frame as its first three counters</returns>
+static bench_result_t* run_box_tiles(const char* name, bool tiles) {
+    sprite_t captured[sizeof(box_tiles) / sizeof(box_tiles[0])];
+    memcpy(captured, box_tiles, sizeof(captured));
+    if (!tiles) {
+        memset(box_tiles, 0, sizeof(box_tiles));
+    }
+    frames[0].valid = false;
+    frames[1].valid = false;
+    bench_result_t* result = run_primitive(name, bench_render_replay, N_REPLAY);
+
+    frames[0].valid = false;
+    frames[1].valid = false;
+    memset(&dma2d_stats, 0, sizeof(dma2d_stats));
+    for (size_t i = 0; i < N_REPLAY; ++i) {
+        bench_render_replay(i);
+    }
+    bench_counter(result, "dma2d_commands", (double)dma2d_stats.commands / N_REPLAY);
+    memcpy(box_tiles, captured, sizeof(captured));
+    return result;
+}
+
+/// <summary>
+/// Renders every recorded snapshot incrementally into one frame buffer and completely into another, and compares
+/// what both show on the screen
+/// </summary>
+/// <returns>number of frames where the incremental render differs from the full redraw</returns>
+static uint32_t check_replay(void) {
+    uint32_t failed = 0;
+    frames[0].valid = false;
+    for (size_t i = 0; i < N_REPLAY; ++i) {
+        host_lcd_select(0);
+        render(0, &replay[i]);
+        frames[1].valid = false;
+        host_lcd_select(1);
+        render(1, &replay[i]);
+        dma2d_fence();
+        for (uint32_t p = 0; p < LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT; ++p) {
+            if (host_lcd_composite(0, p) != host_lcd_composite(1, p)) {
+                ++failed;
+                break;
+            }
+        }
+    }
+    frames[0].valid = false;
+    frames[1].valid = false;
+    return failed;
+}
+
+/// <summary>
+/// Tests whether the center of a pixel is inside the polygon by counting the edges a ray to the right crosses
+/// </summary>
+/// <param name="points">of the polygon</param>
+/// <param name="count">number of points</param>
+/// <param name="x">of the pixel</param>
+/// <param name="y">of the pixel</param>
+/// <returns>true if an odd number of edges is crossed</returns>
+static bool reference_inside(const Point* points, uint32_t count, int32_t x, int32_t y) {
+    //In doubled coordinates the center is at (2x + 1, 2y + 1) and every comparison is exact
+    const int64_t px = 2 * x + 1, py = 2 * y + 1;
+    bool inside = false;
+    for (uint32_t i = 0; i < count; ++i) {
+        const int64_t x1 = 2 * points[i].X, y1 = 2 * points[i].Y;
+        const int64_t x2 = 2 * points[(i + 1) % count].X, y2 = 2 * points[(i + 1) % count].Y;
+        if ((y1 <= py) == (y2 <= py)) {
+            continue;
+        }
+        //The crossing is right of the center if px < x1 + (py - y1) * (x2 - x1) / (y2 - y1)
+        const int64_t lhs = (px - x1) * (y2 - y1), rhs = (py - y1) * (x2 - x1);
+        if ((y2 > y1) ? (lhs < rhs) : (lhs > rhs)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/// <summary>
+/// Fills the polygon on a cleared frame buffer and compares every pixel with the reference
+/// </summary>
+/// <param name="points">of the polygon</param>
+/// <param name="count">number of points</param>
+/// <returns>number of pixels that differ</returns>
+static uint32_t check_polygon(const Point* points, uint32_t count) {
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_FillPolygon((pPoint)points, count, UTIL_LCD_COLOR_WHITE);
+    dma2d_fence();
+    uint32_t mismatches = 0;
+    for (uint32_t y = 0; y < LCD_DEFAULT_HEIGHT; ++y) {
+        for (uint32_t x = 0; x < LCD_DEFAULT_WIDTH; ++x) {
+            uint32_t color;
+            UTIL_LCD_GetPixel(x, y, &color);
+            mismatches += (color == UTIL_LCD_COLOR_WHITE) != reference_inside(points, count, x, y);
+        }
+    }
+    return mismatches;
+}
+
+/// <summary>
+/// Draws the outline of the polygon with UTIL_LCD_DrawPolygon and with per_pixel_polygon and compares the pixels
+/// </summary>
+/// <param name="points">of the polygon</param>
+/// <param name="count">number of points</param>
+/// <returns>number of pixels that differ</returns>
+static uint32_t check_outline(const Point* points, uint32_t count) {
+    static uint32_t expected[LCD_DEFAULT_HEIGHT][LCD_DEFAULT_WIDTH];
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    per_pixel_polygon(points, count, UTIL_LCD_COLOR_WHITE);
+    dma2d_fence();
+    for (uint32_t y = 0; y < LCD_DEFAULT_HEIGHT; ++y) {
+        for (uint32_t x = 0; x < LCD_DEFAULT_WIDTH; ++x) {
+            UTIL_LCD_GetPixel(x, y, &expected[y][x]);
+        }
+    }
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_DrawPolygon((pPoint)points, count, UTIL_LCD_COLOR_WHITE);
+    dma2d_fence();
+    uint32_t mismatches = 0;
+    for (uint32_t y = 0; y < LCD_DEFAULT_HEIGHT; ++y) {
+        for (uint32_t x = 0; x < LCD_DEFAULT_WIDTH; ++x) {
+            uint32_t color;
+            UTIL_LCD_GetPixel(x, y, &color);
+            mismatches += color != expected[y][x];
+        }
+    }
+    return mismatches;
+}
+
+/// <summary>
+/// Checks the run based outlines against the per pixel ones on the button icons and on random on screen polygons
+/// </summary>
+/// <returns>number of polygons with differing pixels</returns>
+static uint32_t check_draw_polygon(void) {
+    uint32_t failed = 0;
+    uint32_t seed = 2025;
+    host_lcd_select(0);
+    UTIL_LCD_BeginFrame();
+    for (size_t i = 0; i < N_POLYGONS; ++i) {
+        failed += check_outline(polygons[i], polygon_sizes[i]) != 0;
+    }
+    for (size_t i = 0; i < N_RANDOM_POLYGONS; ++i) {
+        Point points[MAX_RANDOM_POINTS];
+        seed = seed * 1103515245 + 12345;
+        const uint32_t count = 2 + (seed >> 16) % (MAX_RANDOM_POINTS - 1);
+        for (uint32_t p = 0; p < count; ++p) {
+            seed = seed * 1103515245 + 12345;
+            points[p].X = (int16_t)((seed >> 8) % LCD_DEFAULT_WIDTH);
+            seed = seed * 1103515245 + 12345;
+            points[p].Y = (int16_t)((seed >> 8) % LCD_DEFAULT_HEIGHT);
+        }
+        failed += check_outline(points, count) != 0;
+    }
+    frames[0].valid = false;
+    return failed;
+}
+
+/// <summary>
+/// Checks the polygon fill against the reference on the button icons and on random, partly self intersecting and
+/// partly off screen polygons
+/// </summary>
+/// <returns>number of polygons with differing pixels</returns>
+static uint32_t check_fill_polygon(void) {
+    uint32_t failed = 0;
+    uint32_t seed = 2024;
+    host_lcd_select(0);
+    UTIL_LCD_BeginFrame();
+    for (size_t i = 0; i < N_POLYGONS; ++i) {
+        failed += check_polygon(polygons[i], polygon_sizes[i]) != 0;
+    }
+    for (size_t i = 0; i < N_RANDOM_POLYGONS; ++i) {
+        Point points[MAX_RANDOM_POINTS];
+        seed = seed * 1103515245 + 12345;
+        const uint32_t count = 3 + (seed >> 16) % (MAX_RANDOM_POINTS - 2);
+        for (uint32_t p = 0; p < count; ++p) {
+            seed = seed * 1103515245 + 12345;
+            points[p].X = (int16_t)((seed >> 8) % (LCD_DEFAULT_WIDTH + 80)) - 40;
+            seed = seed * 1103515245 + 12345;
+            points[p].Y = (int16_t)((seed >> 8) % (LCD_DEFAULT_HEIGHT + 80)) - 40;
+        }
+        failed += check_polygon(points, count) != 0;
+    }
+    frames[0].valid = false;
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    static char replay_names[N_PRIMS][48];
+    static char full_names[N_PRIMS][48];
+    const char* json = bench_json_path(argc, argv);
+
+    host_config(LCD_FRAME_FORMAT);
+    for (size_t p = 0; p < N_PRIMS; ++p) {
+        snprintf(replay_names[p], sizeof(replay_names[p]), "render/replay/%s", primitive_names[p]);
+        snprintf(full_names[p], sizeof(full_names[p]), "render/full/%s", primitive_names[p]);
+    }
+
+    run_primitive("FillRect/box", bench_fill_rect, 1 << 16);
+    run_primitive("DrawRect/box", bench_draw_rect, 1 << 16);
+    const bench_result_t* outline = run_primitive("DrawPolygon/button", bench_draw_polygon, 1 << 14);
+    use_direct(false);
+    const bench_result_t* per_pixel = run_primitive("DrawPolygon/button/per_pixel", bench_draw_polygon_per_pixel, 1 << 14);
+    const bench_result_t* outline_driver = run_primitive("DrawPolygon/button/driver", bench_draw_polygon, 1 << 14);
+    use_direct(true);
+    run_primitive("DisplayStringAt/hud", bench_display_string_at, 1 << 12);
+    const bench_result_t* glyph_hits = run_glyphs("DisplayStringAt/hud/cached", bench_display_string_at, 1 << 12);
+    const bench_result_t* glyph_misses = run_glyphs("DisplayStringAt/hud/expanded", bench_display_string_at_miss, 1 << 12);
+    UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);
+    //Without the glyph cache in the retained memory every cached glyph is copied into the staging memory first
+    dma2d_retain((uintptr_t)LCD_LABEL_ADDRESS, LCD_SPRITE_ADDRESS + LCD_SPRITE_SIZE - LCD_LABEL_ADDRESS);
+    const bench_result_t* glyph_staged = run_glyphs("DisplayStringAt/hud/staged", bench_display_string_at, 1 << 12);
+    dma2d_retain((uintptr_t)LCD_GLYPH_CACHE_ADDRESS, LCD_SPRITE_ADDRESS + LCD_SPRITE_SIZE - LCD_GLYPH_CACHE_ADDRESS);
+    run_primitive("FillPolygon/button", bench_fill_polygon, 1 << 12);
+    run_primitive("FillCircle/r10", bench_fill_circle, 1 << 14);
+    const bench_result_t* clear = run_primitive("Clear", bench_clear, 1 << 8);
+    const bench_result_t* sync_disjoint = run_sync("sync/other_lines", bench_sync_disjoint, 1 << 10);
+    const bench_result_t* sync_overlap = run_sync("sync/same_lines", bench_sync_overlap, 1 << 10);
+
+    //Frame times are per rendered frame, the breakdown is per frame and its timers make it slower than the total
+    record_replay();
+    run_primitive("render/replay", bench_render_replay, N_REPLAY);
+    profile_frames(bench_render_replay, replay_names);
+    const bench_result_t* full = run_primitive("render/full", bench_render_full, N_REPLAY / 2);
+    profile_frames(bench_render_full, full_names);
+    const bench_result_t* one_layer = run_primitive("render/full/one_layer", bench_render_full_one_layer, N_REPLAY / 2);
+    use_direct(false);
+    const bench_result_t* full_driver = run_primitive("render/full/driver", bench_render_full, N_REPLAY / 2);
+    use_direct(true);
+    compare_formats();
+    const bench_result_t* tiles = run_box_tiles("render/replay/tiles", true);
+    const bench_result_t* boxes = run_box_tiles("render/replay/boxes", false);
+    use_direct(false);
+    const bench_result_t* tiles_driver = run_box_tiles("render/replay/tiles/driver", true);
+    const bench_result_t* boxes_driver = run_box_tiles("render/replay/boxes/driver", false);
+    use_direct(true);
+
+    const uint32_t replay_failed = check_replay();
+    const uint32_t polygons_failed = check_fill_polygon();
+    //Both the direct writes and the driver path must draw the pixels of the per pixel lines
+    uint32_t outlines_failed = check_draw_polygon();
+    use_direct(false);
+    outlines_failed += check_draw_polygon();
+    use_direct(true);
+
+    bench_report(stdout);
+    printf("replay: %u of %u incrementally rendered frames differ from a full redraw\n", replay_failed, N_REPLAY);
+    printf("polygon fill: %u of %u polygons differ from the reference\n", polygons_failed, N_POLYGONS + N_RANDOM_POLYGONS);
+    printf("polygon outline: %u of %u polygons differ from the per pixel lines\n", outlines_failed, 2 * (N_POLYGONS + N_RANDOM_POLYGONS));
+    //Cached glyphs are blitted straight from the cache, expanded ones also pay for the expansion and the eviction
+    printf("glyph cache: %.0f ns per cached glyph, %.0f ns when it is staged, %.0f ns per expanded glyph\n",
+        glyph_hits->ns_per_op / (glyph_hits->counters[0] + glyph_hits->counters[1]),
+        glyph_staged->ns_per_op / (glyph_staged->counters[0] + glyph_staged->counters[1]),
+        glyph_misses->ns_per_op / (glyph_misses->counters[0] + glyph_misses->counters[1]));
+    printf("line runs: %.1f instead of %.1f driver calls per button outline, %.2f instead of %.2f us\n",
+        outline->counters[0], per_pixel->counters[0], outline->ns_per_op / 1000.0, per_pixel->ns_per_op / 1000.0);
+    //Without the background layer the border and the button frames were drawn into every full frame
+    const double single_pixels = one_layer->counters[1] - clear->counters[1];
+    const double single_ns = one_layer->ns_per_op - clear->ns_per_op;
+    //The counting driver sees every pixel, the direct writes only show in the times
+    printf("direct writes: %.2f instead of %.2f us per button outline, %.1f instead of %.1f us per full frame\n",
+        outline->ns_per_op / 1000.0, outline_driver->ns_per_op / 1000.0, full->ns_per_op / 1000.0,
+        full_driver->ns_per_op / 1000.0);
+    printf("direct writes: %.1f of %.1f syncs per outline waited for a fill on other lines, %.1f of %.1f for a fill on "
+        "the same lines\n", sync_disjoint->counters[1], sync_disjoint->counters[0], sync_overlap->counters[1],
+        sync_overlap->counters[0]);
+    printf("box tiles: %.1f instead of %.1f driver calls, %.1f instead of %.1f DMA2D commands, %.1f instead of %.1f us per "
+        "replayed frame\n", tiles->counters[0], boxes->counters[0], tiles->counters[2], boxes->counters[2],
+        tiles->ns_per_op / 1000.0, boxes->ns_per_op / 1000.0);
+    printf("box tiles without direct writes: %.1f instead of %.1f DMA2D commands, %.1f instead of %.1f us per replayed "
+        "frame\n", tiles_driver->counters[2], boxes_driver->counters[2], tiles_driver->ns_per_op / 1000.0,
+        boxes_driver->ns_per_op / 1000.0);
+    printf("background layer: %.0f instead of %.0f pixels per full frame, %.1f%% less fill, %.1f%% less time\n",
+        full->counters[1], single_pixels, 100.0 * (1.0 - full->counters[1] / single_pixels),
+        100.0 * (1.0 - full->ns_per_op / single_ns));
+    //The saved fill is only written when a frame is drawn in full, the second layer is read on every refresh
+    const double saved_bytes = (single_pixels - full->counters[1]) * bytes_per_pixel(LCD_FRAME_FORMAT);
+    const double added_mb_s = layer_scanout_mb_s(LCD_FRAME_FORMAT);
+    printf("background layer: scanning it out adds %.1f MB/s of LTDC reads, as much as the saved fill of %.0f full "
+        "frames per second\n", added_mb_s, added_mb_s * 1024.0 * 1024.0 / saved_bytes);
+    if (json != NULL && bench_write_json(json, "render") != 0) {
+        return 1;
+    }
+    return (replay_failed == 0 && polygons_failed == 0 && outlines_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/*
+ * bench_ring.c
+ *
+ *  Action ring stress test: two producer threads stand in for the input task and the button interrupt,
+ *  one consumer thread drains both rings like the lcd task and checks that no event is lost or reordered
+ */
+#include "main.h"
+#include "bench.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define PRODUCERS 2
+#define STRESS_EVENTS (1U << 22) //Events pushed by each producer
+
+typedef struct {
+    action_ring_t ring;
+    uint32_t source; //Stored in the events to tell the producers apart
+    uint64_t full; //Pushes retried because the consumer fell behind
+} producer_t;
+
+static producer_t producers[PRODUCERS];
+static atomic_uint finished = 0;
+static uint64_t consumed[PRODUCERS];
+static uint64_t errors = 0;
+static action_ring_t bench_ring;
+
+/// <summary>
+/// Pushes the sequence numbers of one producer as the timestamps of its events
+/// </summary>
+/// <param name="argument">producer_t of the thread</param>
+/// <returns>NULL</returns>
+static void* produce(void* argument) {
+    producer_t* producer = argument;
+    for (uint32_t i = 0; i < STRESS_EVENTS; ++i) {
+        const input_event_t event = { i % N_ACTIONS, INPUT_PRESS, i, producer->source };
+        while (!action_ring_push(&producer->ring, &event)) {
+            ++producer->full;
+            sched_yield(); //Also makes progress when the threads share a core
+        }
+    }
+    atomic_fetch_add(&finished, 1);
+    return NULL;
+}
+
+/// <summary>
+/// Drains the rings in timestamp order and checks that every producer's sequence arrives complete and in order
+/// </summary>
+/// <param name="argument">unused</param>
+/// <returns>NULL</returns>
+static void* consume(void* argument) {
+    (void)argument;
+    action_ring_t* rings[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        rings[i] = &producers[i].ring;
+    }
+    input_event_t event;
+    for (;;) {
+        const bool done = atomic_load(&finished) == PRODUCERS; //Read before the pop, so that no late push is missed
+        if (!action_ring_pop_oldest(rings, PRODUCERS, &event)) {
+            if (done) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        if (event.source >= PRODUCERS) {
+            ++errors;
+            continue;
+        }
+        if (event.timestamp != consumed[event.source] || event.action != event.timestamp % N_ACTIONS) {
+            if (errors++ < 4) {
+                printf("producer %u: event %u arrived as number %llu\n", event.source, event.timestamp,
+                    (unsigned long long)consumed[event.source]);
+            }
+        }
+        ++consumed[event.source];
+    }
+    return NULL;
+}
+
+static void bench_push_pop(size_t i) {
+    const input_event_t event = { MOVE_LEFT, INPUT_PRESS, i, INPUT_SOURCE_BUTTON };
+    input_event_t popped;
+    action_ring_push(&bench_ring, &event);
+    action_ring_pop(&bench_ring, &popped);
+}
+
+static void bench_merge(size_t i) {
+    static action_ring_t* const rings[] = { &producers[0].ring, &producers[1].ring };
+    const input_event_t event = { MOVE_LEFT, INPUT_PRESS, i, INPUT_SOURCE_BUTTON };
+    input_event_t popped;
+    action_ring_push(rings[i & 1], &event);
+    action_ring_pop_oldest(rings, PRODUCERS, &popped);
+}
+
+int main(int argc, char** argv) {
+    const char* json = bench_json_path(argc, argv);
+    pthread_t threads[PRODUCERS + 1];
+
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        action_ring_init(&producers[i].ring);
+        producers[i].source = i;
+    }
+    const uint64_t start = bench_now_ns();
+    pthread_create(&threads[PRODUCERS], NULL, consume, NULL);
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        pthread_create(&threads[i], NULL, produce, &producers[i]);
+    }
+    for (uint32_t i = 0; i <= PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    const uint64_t elapsed = bench_now_ns() - start;
+
+    bool complete = errors == 0;
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        printf("producer %u: %llu of %u events, %llu pushes on a full ring\n", i, (unsigned long long)consumed[i],
+            STRESS_EVENTS, (unsigned long long)producers[i].full);
+        complete = complete && consumed[i] == STRESS_EVENTS;
+    }
+    bench_result_t* result = bench_add("ring/stress", (double)elapsed / (PRODUCERS * STRESS_EVENTS), PRODUCERS * STRESS_EVENTS);
+    bench_counter(result, "full", (double)(producers[0].full + producers[1].full) / (PRODUCERS * STRESS_EVENTS));
+
+    action_ring_init(&bench_ring);
+    bench_run("ring/push_pop", bench_push_pop, 1 << 20);
+    action_ring_init(&producers[0].ring);
+    action_ring_init(&producers[1].ring);
+    bench_run("ring/merge", bench_merge, 1 << 20);
+
+    bench_report(stdout);
+    printf("ring stress: %s, %llu errors\n", complete ? "complete" : "incomplete", (unsigned long long)errors);
+    if (json != NULL && bench_write_json(json, "ring") != 0) {
+        return 1;
+    }
+    return complete ? 0 : 1;
+}
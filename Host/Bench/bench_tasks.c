@@ -0,0 +1,148 @@
+/*
+ * bench_tasks.c
+ *
+ *  The logic and lcd tasks on their own threads: a timer thread raises the logic tick every LOGIC_PERIOD_US while the
+ *  renderer is slowed down on purpose, and the logic steps have to keep starting within LOGIC_JITTER_LIMIT_US. The
+ *  timer and the logic threads ask for real time priorities, without them the host scheduler may delay a step
+ */
+#include "main.h"
+#include "bench.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+
+#define TASK_TICKS 300 //Three seconds of game time
+#define RENDER_DELAY_US 35000 //Extra time of every frame, longer than three ticks
+#define TAP_FRAMES 2 //Frames between the random taps
+#define TAP_BUTTONS 5 //The last button is play/pause, which would stop the game
+
+static action_ring_t input_ring;
+static sem_t tick_flag; //Stands in for the thread flag of the logic task
+static atomic_bool ticking = true;
+static uint32_t missed_periods = 0; //Timer periods that passed while the host did not run the timer thread
+static uint32_t frames = 0;
+static uint64_t frame_ns = 0;
+
+static void queue_input_event(const input_event_t* event) {
+    action_ring_push(&input_ring, event);
+}
+
+/// <summary>
+/// Gives the thread a real time priority like the interrupt and the logic task have over the lcd task on the target
+/// </summary>
+/// <param name="priority">SCHED_FIFO priority</param>
+/// <returns>true if the priority was granted</returns>
+static bool raise_priority(int priority) {
+    const struct sched_param param = { .sched_priority = priority };
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+/// <summary>
+/// Raises the tick on an absolute period like TIM2 does, so a late wake up does not shift the following ticks. Periods
+/// that passed while the thread did not run raise no tick of their own, like the update interrupt that is only pending
+/// once
+/// </summary>
+/// <param name="argument">set to true if the real time priority was granted</param>
+/// <returns>NULL</returns>
+static void* tick_timer(void* argument) {
+    *(bool*)argument = raise_priority(2);
+    uint64_t next = bench_now_ns();
+    for (uint32_t i = 0; i < TASK_TICKS; ++i) {
+        next += LOGIC_PERIOD_US * 1000;
+        const struct timespec deadline = { next / 1000000000, next % 1000000000 };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        logic_tick_irq();
+        sem_post(&tick_flag);
+        while (bench_now_ns() >= next + LOGIC_PERIOD_US * 1000) {
+            next += LOGIC_PERIOD_US * 1000;
+            ++missed_periods;
+        }
+    }
+    atomic_store(&ticking, false);
+    return NULL;
+}
+
+/// <summary>
+/// The loop of the logic task, woken up by the tick, until every tick was simulated
+/// </summary>
+/// <param name="argument">set to true if the real time priority was granted</param>
+/// <returns>NULL</returns>
+static void* logic_task(void* argument) {
+    action_ring_t* const rings[] = { &input_ring };
+    *(bool*)argument = raise_priority(1);
+    logic_init();
+    while (logic_stats.steps < TASK_TICKS) {
+        sem_wait(&tick_flag);
+        logic_step(rings, 1);
+    }
+    return NULL;
+}
+
+/// <summary>
+/// Keeps the CPU busy, a slow frame occupies the renderer instead of letting it sleep
+/// </summary>
+/// <param name="us">time to spin</param>
+static void spin(uint32_t us) {
+    const uint64_t end = bench_now_ns() + (uint64_t)us * 1000;
+    while (bench_now_ns() < end) {
+    }
+}
+
+/// <summary>
+/// The loop of the lcd task with random taps on the simulated panel, every frame takes RENDER_DELAY_US longer
+/// </summary>
+static void lcd_task(void) {
+    uint32_t seed = 12345;
+    swapchain_init();
+    vsync_init();
+    while (atomic_load(&ticking)) {
+        const uint64_t start = bench_now_ns();
+        if (frames % TAP_FRAMES == 0) {
+            seed = seed * 1103515245 + 12345;
+            const button_t* btn = &buttons[(seed >> 16) % TAP_BUTTONS];
+            host_ts_touch(0, btn->x + X_BTN / 2, btn->y + Y_BTN / 2);
+            input_scan();
+        } else if (input_touching()) {
+            host_ts_release(0);
+            input_scan();
+        }
+        const uint32_t buffer = swapchain_acquire();
+        const snapshot_t* snapshot = logic_snapshot();
+        render(buffer, snapshot);
+        dma2d_fence();
+        spin(RENDER_DELAY_US);
+        swapchain_present(buffer);
+        vsync_present(snapshot->sequence);
+        frame_ns += bench_now_ns() - start;
+        ++frames;
+    }
+}
+
+int main(void) {
+    pthread_t timer, logic;
+    bool timer_priority = false, logic_priority = false;
+
+    host_config(LCD_FRAME_FORMAT);
+    action_ring_init(&input_ring);
+    input_init(queue_input_event);
+    reset_game();
+    sem_init(&tick_flag, 0, 0);
+
+    pthread_create(&logic, NULL, logic_task, &logic_priority);
+    pthread_create(&timer, NULL, tick_timer, &timer_priority);
+    lcd_task();
+    pthread_join(timer, NULL);
+    pthread_join(logic, NULL);
+
+    printf("frames: %u, %.1f ms per frame, real time priority of the timer: %s, of the logic task: %s\n", frames,
+        (double)frame_ns / frames / 1000000, timer_priority ? "yes" : "no", logic_priority ? "yes" : "no");
+    printf("logic ticks: %u, steps: %u, late: %u, max jitter: %u us of %u us, max step: %u us\n", logic_stats.ticks,
+        logic_stats.steps, logic_stats.late, logic_stats.max_jitter_us, LOGIC_JITTER_LIMIT_US, logic_stats.max_step_us);
+    printf("timer periods missed by the host: %u\n", missed_periods);
+    printf("snapshots published: %u, rendered: %u, skipped: %u, actions: %u\n", logic_stats.published,
+        logic_stats.rendered, logic_stats.skipped, input_stats.actions);
+    const bool on_time = logic_stats.steps == TASK_TICKS && logic_stats.max_jitter_us < LOGIC_JITTER_LIMIT_US;
+    printf("logic under a slow renderer: %s\n", on_time ? "on time" : "late");
+    return on_time ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+/*
+ * main.h
+ *
+ *  Host replacement of the firmware main.h, exposes the game core and the stand-ins
+ */
+
+#ifndef HOST_INC_MAIN_H_
+#define HOST_INC_MAIN_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "stm32h7xx_hal.h"
+#include "tetris.h"
+#include "stm32h750b_discovery_lcd.h"
+#include "stm32h750b_discovery_mmc.h"
+#include "stm32h750b_discovery_ts.h"
+#include "stm32_lcd.h"
+#include "dma2d_queue.h"
+#include "input.h"
+#include "action_ring.h"
+#include "logic.h"
+#include "vsync.h"
+#include "swapchain.h"
+#include "palette.h"
+
+void host_config(uint32_t pixel_format);
+
+#endif /* HOST_INC_MAIN_H_ */
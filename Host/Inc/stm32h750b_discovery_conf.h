@@ -0,0 +1,33 @@
+/*
+ * stm32h750b_discovery_conf.h
+ *
+ *  Host stand-in for the board configuration, the SDRAM is an ordinary array
+ */
+
+#ifndef HOST_INC_STM32H750B_DISCOVERY_CONF_H_
+#define HOST_INC_STM32H750B_DISCOVERY_CONF_H_
+
+#include "stm32h7xx_hal.h"
+
+#define HOST_SDRAM_SIZE                     0x00A00000U
+
+extern uint8_t host_sdram[HOST_SDRAM_SIZE];
+
+//Pixel format of the frame buffers and the background, RGB565 halves the SDRAM traffic of drawing and scan out and
+//L8 quarters it by storing indices into the palette
+#ifndef LCD_FRAME_FORMAT
+#define LCD_FRAME_FORMAT                    LCD_PIXEL_FORMAT_ARGB8888
+#endif
+#define LCD_LAYER_0_ADDRESS                 (host_sdram + 0x00000000U)
+#define LCD_LAYER_1_ADDRESS                 (host_sdram + 0x00200000U)
+#define LCD_LAYER_2_ADDRESS                 (host_sdram + 0x00600000U)
+#define LCD_BACKGROUND_ADDRESS              (host_sdram + 0x00800000U)
+#define LCD_GLYPH_CACHE_ADDRESS             (host_sdram + 0x00400000U)
+#define LCD_GLYPH_CACHE_SIZE                0x00048000U
+#define LCD_LABEL_ADDRESS                   (host_sdram + 0x00448000U)
+//Bitmap of each label, room for LABEL_TEXT_SIZE - 1 characters of Font12 at 4 bytes per pixel
+#define LCD_LABEL_SIZE                      0x00003000U
+#define LCD_SPRITE_ADDRESS                  (host_sdram + 0x0044E000U)
+#define LCD_SPRITE_SIZE                     0x00040000U
+
+#endif /* HOST_INC_STM32H750B_DISCOVERY_CONF_H_ */
@@ -0,0 +1,40 @@
+/*
+ * stm32h750b_discovery_lcd.h
+ *
+ *  Host stand-in for the LCD BSP, draws into the frame buffers and the background layer in the host SDRAM
+ */
+
+#ifndef HOST_INC_STM32H750B_DISCOVERY_LCD_H_
+#define HOST_INC_STM32H750B_DISCOVERY_LCD_H_
+
+#include "stm32h750b_discovery_conf.h"
+#include "lcd.h"
+
+#define LCD_DEFAULT_WIDTH 480U
+#define LCD_DEFAULT_HEIGHT 272U
+#define LCD_BUFFER_COUNT 3U
+
+extern const LCD_UTILS_Drv_t LCD_Driver;
+
+void host_lcd_init(uint32_t pixel_format);
+void host_lcd_select(uint32_t buffer);
+uint8_t* host_lcd_buffer(uint32_t buffer);
+uint32_t host_lcd_composite(uint32_t buffer, uint32_t i);
+void host_lcd_set_clut(const uint32_t* colors, uint32_t count);
+
+int32_t BSP_LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t* pBmp);
+int32_t BSP_LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t* pData, uint32_t Width, uint32_t Height);
+int32_t BSP_LCD_DrawHLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
+int32_t BSP_LCD_DrawVLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
+int32_t BSP_LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
+int32_t BSP_LCD_ReadPixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t* Color);
+int32_t BSP_LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Color);
+int32_t BSP_LCD_GetXSize(uint32_t Instance, uint32_t* XSize);
+int32_t BSP_LCD_GetYSize(uint32_t Instance, uint32_t* YSize);
+int32_t BSP_LCD_SetActiveLayer(uint32_t Instance, uint32_t LayerIndex);
+int32_t BSP_LCD_SetColorKeying(uint32_t Instance, uint32_t LayerIndex, uint32_t Color);
+int32_t BSP_LCD_GetPixelFormat(uint32_t Instance, uint32_t* PixelFormat);
+int32_t BSP_LCD_GetFrameBuffer(uint32_t Instance, LCD_UTILS_FrameBuffer_t* FrameBuffer);
+int32_t BSP_LCD_Sync(uint32_t Instance, uint32_t Ypos, uint32_t Height);
+
+#endif /* HOST_INC_STM32H750B_DISCOVERY_LCD_H_ */
@@ -0,0 +1,20 @@
+/*
+ * stm32h750b_discovery_mmc.h
+ *
+ *  Host stand-in for the eMMC BSP, the blocks are kept in memory
+ */
+
+#ifndef HOST_INC_STM32H750B_DISCOVERY_MMC_H_
+#define HOST_INC_STM32H750B_DISCOVERY_MMC_H_
+
+#include <stdint.h>
+
+#define MMC_BLOCKSIZE 512U
+#define MMC_TRANSFER_OK 0U
+#define HOST_MMC_BLOCK_COUNT 16U
+
+int32_t BSP_MMC_ReadBlocks(uint32_t Instance, uint32_t* pData, uint32_t BlockIdx, uint32_t BlocksNbr);
+int32_t BSP_MMC_WriteBlocks(uint32_t Instance, uint32_t* pData, uint32_t BlockIdx, uint32_t BlocksNbr);
+int32_t BSP_MMC_GetCardState(uint32_t Instance);
+
+#endif /* HOST_INC_STM32H750B_DISCOVERY_MMC_H_ */
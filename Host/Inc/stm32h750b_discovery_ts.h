@@ -0,0 +1,38 @@
+/*
+ * stm32h750b_discovery_ts.h
+ *
+ *  Host stand-in for the touch screen BSP, touches are simulated and raise the touch interrupt
+ */
+
+#ifndef HOST_INC_STM32H750B_DISCOVERY_TS_H_
+#define HOST_INC_STM32H750B_DISCOVERY_TS_H_
+
+#include <stdint.h>
+
+#define TS_TOUCH_NBR 5U
+
+#define GESTURE_ID_NO_GESTURE 0x00U
+#define GESTURE_ID_MOVE_UP 0x01U
+#define GESTURE_ID_MOVE_RIGHT 0x02U
+#define GESTURE_ID_MOVE_DOWN 0x03U
+#define GESTURE_ID_MOVE_LEFT 0x04U
+#define GESTURE_ID_ZOOM_IN 0x05U
+#define GESTURE_ID_ZOOM_OUT 0x06U
+#define GESTURE_ID_NB_MAX 0x07U
+
+typedef struct {
+    uint32_t TouchDetected;
+    uint32_t TouchX[TS_TOUCH_NBR];
+    uint32_t TouchY[TS_TOUCH_NBR];
+    uint32_t TouchWeight[TS_TOUCH_NBR];
+    uint32_t TouchEvent[TS_TOUCH_NBR];
+    uint32_t TouchArea[TS_TOUCH_NBR];
+} TS_MultiTouch_State_t;
+
+int32_t BSP_TS_Get_MultiTouchState(uint32_t Instance, TS_MultiTouch_State_t* TS_State);
+int32_t BSP_TS_GetGestureId(uint32_t Instance, uint32_t* GestureId);
+void host_ts_touch(uint32_t finger, uint32_t x, uint32_t y);
+void host_ts_release(uint32_t finger);
+void host_ts_gesture(uint32_t gesture);
+
+#endif /* HOST_INC_STM32H750B_DISCOVERY_TS_H_ */
@@ -0,0 +1,34 @@
+/*
+ * stm32h7xx_hal.h
+ *
+ *  Host stand-in for the parts of the HAL used by the game core
+ */
+
+#ifndef HOST_INC_STM32H7XX_HAL_H_
+#define HOST_INC_STM32H7XX_HAL_H_
+
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct {
+    uint32_t seed;
+} RNG_HandleTypeDef;
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef* hrng, uint32_t* random32bit);
+DWT_Type* host_dwt(void);
+void host_dwt_set(uint32_t cycles);
+
+//The cycle counter counts nanoseconds of the monotonic clock on the host
+#define DWT (host_dwt())
+
+#endif /* HOST_INC_STM32H7XX_HAL_H_ */
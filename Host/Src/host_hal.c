@@ -0,0 +1,97 @@
+/*
+ * host_hal.c
+ *
+ *  Host stand-ins for the RNG, the eMMC, the cycle counter and the SDRAM
+ */
+#include "main.h"
+#include <time.h>
+
+uint8_t host_sdram[HOST_SDRAM_SIZE];
+RNG_HandleTypeDef rng = { 1 };
+
+static uint32_t mmc[HOST_MMC_BLOCK_COUNT][MMC_BLOCKSIZE / sizeof(uint32_t)];
+static _Thread_local DWT_Type dwt; //Per thread, so that no thread reads a time another one stored in between
+static bool dwt_frozen = false;
+
+/// <summary>
+/// Generates a pseudo random number, the sequence is fixed by the seed in the handle
+/// </summary>
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef* hrng, uint32_t* random32bit) {
+    //xorshift32
+    uint32_t x = hrng->seed ? hrng->seed : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    hrng->seed = x;
+    *random32bit = x;
+    return HAL_OK;
+}
+
+/// <summary>
+/// Updates the cycle counter from the monotonic clock unless it was set to a fixed time
+/// </summary>
+/// <returns>cycle counter registers</returns>
+DWT_Type* host_dwt(void) {
+    if (!dwt_frozen) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        dwt.CYCCNT = (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec);
+    }
+    return &dwt;
+}
+
+/// <summary>
+/// Stops the cycle counter at the given time, used to replay input timelines deterministically
+/// </summary>
+/// <param name="cycles">value of the cycle counter, in nanoseconds</param>
+void host_dwt_set(uint32_t cycles) {
+    dwt_frozen = true;
+    dwt.CYCCNT = cycles;
+}
+
+int32_t BSP_MMC_ReadBlocks(uint32_t Instance, uint32_t* pData, uint32_t BlockIdx, uint32_t BlocksNbr) {
+    (void)Instance;
+    if (BlockIdx + BlocksNbr > HOST_MMC_BLOCK_COUNT) {
+        return -1;
+    }
+    memcpy(pData, mmc[BlockIdx], BlocksNbr * MMC_BLOCKSIZE);
+    return 0;
+}
+
+int32_t BSP_MMC_WriteBlocks(uint32_t Instance, uint32_t* pData, uint32_t BlockIdx, uint32_t BlocksNbr) {
+    (void)Instance;
+    if (BlockIdx + BlocksNbr > HOST_MMC_BLOCK_COUNT) {
+        return -1;
+    }
+    memcpy(mmc[BlockIdx], pData, BlocksNbr * MMC_BLOCKSIZE);
+    return 0;
+}
+
+int32_t BSP_MMC_GetCardState(uint32_t Instance) {
+    (void)Instance;
+    return MMC_TRANSFER_OK;
+}
+
+/// <summary>
+/// Configures the drawing like LCD_Config does on the target
+/// </summary>
+/// <param name="pixel_format">of the frame buffers, LCD_FRAME_FORMAT unless a benchmark compares formats</param>
+void host_config(uint32_t pixel_format) {
+    host_lcd_init(pixel_format);
+    dma2d_queue_init();
+    BSP_LCD_SetColorKeying(0, FOREGROUND_LAYER, TRANSPARENT_COLOR & 0x00FFFFFFU);
+    palette_init();
+    UTIL_LCD_SetFuncDriver(&LCD_Driver);
+    UTIL_LCD_SetLayer(BACKGROUND_LAYER);
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_SetLayer(FOREGROUND_LAYER);
+    UTIL_LCD_SetGlyphCache(LCD_GLYPH_CACHE_ADDRESS, LCD_GLYPH_CACHE_SIZE, dma2d_sync);
+    UTIL_LCD_SetFont(&Font12);
+    UTIL_LCD_SetBackColor(UTIL_LCD_COLOR_BLACK);
+    UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);
+    //The glyph cache, the labels and the sprites follow each other and are blitted without staging
+    dma2d_retain((uintptr_t)LCD_GLYPH_CACHE_ADDRESS, LCD_SPRITE_ADDRESS + LCD_SPRITE_SIZE - LCD_GLYPH_CACHE_ADDRESS);
+    sprite_atlas_init(LCD_SPRITE_ADDRESS, LCD_SPRITE_SIZE);
+    init_sprites();
+    UTIL_LCD_Clear(UTIL_LCD_COLOR_BLACK);
+}
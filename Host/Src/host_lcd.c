@@ -0,0 +1,226 @@
+/*
+ * host_lcd.c
+ *
+ *  Software frame buffers standing in for the LTDC layers, rectangles are drawn through the DMA2D queue like on the
+ *  target
+ */
+#include "main.h"
+
+const LCD_UTILS_Drv_t LCD_Driver = {
+    BSP_LCD_DrawBitmap,
+    BSP_LCD_FillRGBRect,
+    BSP_LCD_DrawHLine,
+    BSP_LCD_DrawVLine,
+    BSP_LCD_FillRect,
+    BSP_LCD_ReadPixel,
+    BSP_LCD_WritePixel,
+    BSP_LCD_GetXSize,
+    BSP_LCD_GetYSize,
+    BSP_LCD_SetActiveLayer,
+    BSP_LCD_GetPixelFormat,
+    BSP_LCD_GetFrameBuffer,
+    BSP_LCD_Sync
+};
+
+static uint8_t* const buffers[LCD_BUFFER_COUNT] = { LCD_LAYER_0_ADDRESS, LCD_LAYER_1_ADDRESS, LCD_LAYER_2_ADDRESS };
+static uint8_t* selected = LCD_LAYER_0_ADDRESS; //Frame buffer of the foreground layer
+static uint8_t* target = LCD_LAYER_0_ADDRESS;
+static uint32_t layer = 0;
+static uint32_t color_key = 0;
+static bool color_keying = false;
+static uint32_t format = LCD_PIXEL_FORMAT_ARGB8888;
+static uint32_t bpp = 4;
+static uint32_t clut[256]; //Colors of the L8 indices
+
+/// <summary>
+/// Sets the pixel format of the frame buffers and clears them
+/// </summary>
+/// <param name="pixel_format">LCD_PIXEL_FORMAT_ARGB8888, LCD_PIXEL_FORMAT_RGB565 or LCD_PIXEL_FORMAT_L8</param>
+void host_lcd_init(uint32_t pixel_format) {
+    format = pixel_format;
+    bpp = (format == LCD_PIXEL_FORMAT_RGB565) ? 2 : (format == LCD_PIXEL_FORMAT_L8) ? 1 : 4;
+    for (uint32_t i = 0; i < LCD_BUFFER_COUNT; ++i) {
+        memset(buffers[i], 0, LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT * bpp);
+    }
+    memset(LCD_BACKGROUND_ADDRESS, 0, LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT * bpp);
+    selected = buffers[0];
+    target = (layer == 0) ? LCD_BACKGROUND_ADDRESS : selected;
+}
+
+/// <summary>
+/// Selects the frame buffer that is drawn into, like setting the layer address on the target
+/// </summary>
+/// <param name="buffer">index of the frame buffer</param>
+void host_lcd_select(uint32_t buffer) {
+    selected = buffers[buffer % LCD_BUFFER_COUNT];
+    if (layer != 0) {
+        target = selected;
+    }
+}
+
+/// <summary>
+/// Gets the pixels of a frame buffer
+/// </summary>
+/// <param name="buffer">index of the frame buffer</param>
+/// <returns>first pixel of the frame buffer</returns>
+uint8_t* host_lcd_buffer(uint32_t buffer) {
+    return buffers[buffer % LCD_BUFFER_COUNT];
+}
+
+/// <summary>
+/// Loads the CLUT the L8 indices are looked up in
+/// </summary>
+/// <param name="colors">ARGB8888 color of every index</param>
+/// <param name="count">number of colors</param>
+void host_lcd_set_clut(const uint32_t* colors, uint32_t count) {
+    memcpy(clut, colors, ((count < 256) ? count : 256) * sizeof(uint32_t));
+}
+
+/// <summary>
+/// Reads a pixel and expands it to ARGB8888 like the LTDC does, by looking L8 indices up in the CLUT and repeating the
+/// high bits of each RGB565 channel
+/// </summary>
+/// <param name="p">pixel in the frame buffer format</param>
+/// <returns>color of the pixel</returns>
+static uint32_t expand(const uint8_t* p) {
+    if (bpp == 1) {
+        return 0xff000000U | clut[*p];
+    }
+    if (bpp != 2) {
+        return *(const uint32_t*)p;
+    }
+    const uint32_t c = *(const uint16_t*)p;
+    const uint32_t r = (c >> 11) & 0x1f, g = (c >> 5) & 0x3f, b = c & 0x1f;
+    return 0xff000000U | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+/// <summary>
+/// Blends a pixel of a frame buffer over the background layer like the LTDC does with color keying
+/// </summary>
+/// <param name="buffer">index of the frame buffer in the foreground layer</param>
+/// <param name="i">index of the pixel</param>
+/// <returns>color on the screen in ARGB8888</returns>
+uint32_t host_lcd_composite(uint32_t buffer, uint32_t i) {
+    const uint32_t color = expand(host_lcd_buffer(buffer) + i * bpp);
+    //The key is compared with the RGB888 value of the pixel
+    if (color_keying && (color & 0x00FFFFFFU) == (color_key & 0x00FFFFFFU)) {
+        return expand(LCD_BACKGROUND_ADDRESS + i * bpp);
+    }
+    return color;
+}
+
+static inline uint8_t* pixel_address(uint32_t x, uint32_t y) {
+    return target + (y * LCD_DEFAULT_WIDTH + x) * bpp;
+}
+
+static inline void write_pixel(uint8_t* p, uint32_t color) {
+    if (bpp == 1) {
+        *p = (uint8_t)color;
+    } else if (bpp == 2) {
+        *(uint16_t*)p = (uint16_t)color;
+    } else {
+        *(uint32_t*)p = color;
+    }
+}
+
+int32_t BSP_LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t* pBmp) {
+    (void)Instance;
+    (void)Xpos;
+    (void)Ypos;
+    (void)pBmp;
+    return -1; //Bitmaps are not used by the game
+}
+
+int32_t BSP_LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t* pData, uint32_t Width, uint32_t Height) {
+    (void)Instance;
+    //The caller's buffer may not outlive this call, so the DMA2D reads a staged copy
+    const uint8_t* staged = dma2d_stage(pData, Width * Height * bpp);
+    if (format == LCD_PIXEL_FORMAT_L8) {
+        //The DMA2D cannot convert to L8, the indices are copied as they are
+        dma2d_copy((uintptr_t)(staged ? staged : pData), 0, (uintptr_t)pixel_address(Xpos, Ypos), LCD_DEFAULT_WIDTH - Width,
+            format, Width, Height);
+    } else {
+        dma2d_convert((uintptr_t)(staged ? staged : pData), 0, format, (uintptr_t)pixel_address(Xpos, Ypos),
+            LCD_DEFAULT_WIDTH - Width, format, Width, Height);
+    }
+    if (staged == NULL) {
+        dma2d_fence();
+    }
+    return 0;
+}
+
+int32_t BSP_LCD_DrawHLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color) {
+    return BSP_LCD_FillRect(Instance, Xpos, Ypos, Length, 1, Color);
+}
+
+int32_t BSP_LCD_DrawVLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color) {
+    return BSP_LCD_FillRect(Instance, Xpos, Ypos, 1, Length, Color);
+}
+
+int32_t BSP_LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color) {
+    (void)Instance;
+    dma2d_fill((uintptr_t)pixel_address(Xpos, Ypos), LCD_DEFAULT_WIDTH - Width, format, Width, Height, Color);
+    return 0;
+}
+
+int32_t BSP_LCD_ReadPixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t* Color) {
+    (void)Instance;
+    dma2d_fence(); //The queued transfers land first
+    const uint8_t* p = pixel_address(Xpos, Ypos);
+    *Color = (bpp == 1) ? *p : (bpp == 2) ? *(const uint16_t*)p : *(const uint32_t*)p;
+    return 0;
+}
+
+int32_t BSP_LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Color) {
+    (void)Instance;
+    dma2d_fence(); //The CPU write stays ordered after the queued transfers
+    write_pixel(pixel_address(Xpos, Ypos), Color);
+    return 0;
+}
+
+int32_t BSP_LCD_GetXSize(uint32_t Instance, uint32_t* XSize) {
+    (void)Instance;
+    *XSize = LCD_DEFAULT_WIDTH;
+    return 0;
+}
+
+int32_t BSP_LCD_GetYSize(uint32_t Instance, uint32_t* YSize) {
+    (void)Instance;
+    *YSize = LCD_DEFAULT_HEIGHT;
+    return 0;
+}
+
+int32_t BSP_LCD_SetActiveLayer(uint32_t Instance, uint32_t LayerIndex) {
+    (void)Instance;
+    layer = LayerIndex;
+    target = (layer == 0) ? LCD_BACKGROUND_ADDRESS : selected;
+    return 0;
+}
+
+int32_t BSP_LCD_SetColorKeying(uint32_t Instance, uint32_t LayerIndex, uint32_t Color) {
+    (void)Instance;
+    (void)LayerIndex;
+    color_key = Color;
+    color_keying = true;
+    return 0;
+}
+
+int32_t BSP_LCD_GetPixelFormat(uint32_t Instance, uint32_t* PixelFormat) {
+    (void)Instance;
+    *PixelFormat = format;
+    return 0;
+}
+
+int32_t BSP_LCD_GetFrameBuffer(uint32_t Instance, LCD_UTILS_FrameBuffer_t* FrameBuffer) {
+    (void)Instance;
+    FrameBuffer->pAddress = target;
+    FrameBuffer->Stride = LCD_DEFAULT_WIDTH * bpp;
+    FrameBuffer->PixelFormat = format;
+    return 0;
+}
+
+int32_t BSP_LCD_Sync(uint32_t Instance, uint32_t Ypos, uint32_t Height) {
+    (void)Instance;
+    dma2d_sync((uintptr_t)(target + Ypos * LCD_DEFAULT_WIDTH * bpp), Height * LCD_DEFAULT_WIDTH * bpp);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * host_ts.c
+ *
+ *  Simulated touch panel, every new report raises the touch interrupt like the FT5336 does
+ */
+#include "main.h"
+
+typedef struct {
+    bool down;
+    uint32_t x;
+    uint32_t y;
+} finger_t;
+
+static finger_t fingers[TS_TOUCH_NBR];
+static uint32_t gesture_id = GESTURE_ID_NO_GESTURE;
+
+/// <summary>
+/// Checks if any finger is on the panel
+/// </summary>
+/// <param name=""></param>
+/// <returns>true if the controller keeps reporting</returns>
+static bool any_down(void) {
+    for (uint32_t i = 0; i < TS_TOUCH_NBR; ++i) {
+        if (fingers[i].down) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// <summary>
+/// Puts a finger on the panel or moves it, the controller reports it with an interrupt
+/// </summary>
+/// <param name="finger">index of the finger</param>
+/// <param name="x">position of the touch</param>
+/// <param name="y">position of the touch</param>
+void host_ts_touch(uint32_t finger, uint32_t x, uint32_t y) {
+    if (!any_down()) {
+        gesture_id = GESTURE_ID_NO_GESTURE; //A new touch starts a new gesture
+    }
+    fingers[finger % TS_TOUCH_NBR] = (finger_t){ true, x, y };
+    input_touch_irq();
+}
+
+/// <summary>
+/// Lifts a finger, the controller reports the remaining fingers and stops reporting after the last one is lifted
+/// </summary>
+/// <param name="finger">index of the finger</param>
+void host_ts_release(uint32_t finger) {
+    fingers[finger % TS_TOUCH_NBR].down = false;
+    if (any_down()) {
+        input_touch_irq();
+    }
+}
+
+/// <summary>
+/// Sets the gesture the controller recognized in the touch that is in progress, reported with the next touch report
+/// </summary>
+/// <param name="gesture">GESTURE_ID_*</param>
+void host_ts_gesture(uint32_t gesture) {
+    gesture_id = gesture;
+}
+
+int32_t BSP_TS_GetGestureId(uint32_t Instance, uint32_t* GestureId) {
+    (void)Instance;
+    *GestureId = gesture_id;
+    return 0;
+}
+
+int32_t BSP_TS_Get_MultiTouchState(uint32_t Instance, TS_MultiTouch_State_t* TS_State) {
+    (void)Instance;
+    //The controller lists the touches without gaps
+    TS_State->TouchDetected = 0;
+    for (uint32_t i = 0; i < TS_TOUCH_NBR; ++i) {
+        if (fingers[i].down) {
+            TS_State->TouchX[TS_State->TouchDetected] = fingers[i].x;
+            TS_State->TouchY[TS_State->TouchDetected] = fingers[i].y;
+            ++TS_State->TouchDetected;
+        }
+    }
+    return 0;
+}
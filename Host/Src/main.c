@@ -0,0 +1,101 @@
+/*
+ * main.c
+ *
+ *  Plays the game headless on the host: the frame loop of the lcd task with random taps on the simulated panel
+ */
+#include "main.h"
+#include <stdlib.h>
+
+#define FRAME_TICKS 2 //The lcd task renders every 20 ms, the logic task steps every 10 ms
+#define TAP_BUTTONS 5 //The last button is play/pause, which the random player leaves alone
+
+static action_ring_t input_ring;
+
+/// <summary>
+/// Queues the actions of the input layer for the frame loop like the input task does on the target
+/// </summary>
+/// <param name="event">action and the time of its touch</param>
+static void queue_input_event(const input_event_t* event) {
+    action_ring_push(&input_ring, event);
+}
+
+/// <summary>
+/// Writes a frame buffer blended over the background layer as a binary PPM image
+/// </summary>
+/// <param name="path">of the image</param>
+/// <param name="buffer">index of the frame buffer</param>
+static void write_ppm(const char* path, uint32_t buffer) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", LCD_DEFAULT_WIDTH, LCD_DEFAULT_HEIGHT);
+    for (uint32_t i = 0; i < LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT; ++i) {
+        const uint32_t pixel = host_lcd_composite(buffer, i);
+        const uint8_t rgb[3] = { pixel >> 16, pixel >> 8, pixel };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    fclose(file);
+}
+
+int main(int argc, char** argv) {
+    const uint32_t frames = (argc > 1) ? strtoul(argv[1], NULL, 0) : 3000;
+    const char* image = (argc > 2) ? argv[2] : NULL;
+    uint32_t action_seed = 12345;
+    action_ring_t* const rings[] = { &input_ring };
+
+    host_config(LCD_FRAME_FORMAT);
+    action_ring_init(&input_ring);
+    input_init(queue_input_event);
+    reset_game();
+    logic_init();
+    vsync_init();
+    swapchain_init();
+
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        if (frame % 4 == 0) {
+            action_seed = action_seed * 1103515245 + 12345;
+            const button_t* btn = &buttons[(action_seed >> 16) % TAP_BUTTONS];
+            host_ts_touch(0, btn->x + X_BTN / 2, btn->y + Y_BTN / 2);
+            input_scan();
+        } else if (input_touching()) {
+            host_ts_release(0);
+            input_scan(); //The release timeout of the input task
+        }
+        input_repeat(input_timestamp());
+        if (game_over) {
+            perform_action(RESET_GAME);
+        }
+        for (uint32_t i = 0; i < FRAME_TICKS; ++i) {
+            logic_tick_irq();
+            logic_step(rings, 1);
+        }
+        const uint32_t buffer = swapchain_acquire();
+        const snapshot_t* snapshot = logic_snapshot();
+        render(buffer, snapshot);
+        dma2d_fence();
+        swapchain_present(buffer);
+        vsync_present(snapshot->sequence);
+    }
+
+    uint32_t hits, misses;
+    UTIL_LCD_GetGlyphCacheStats(&hits, &misses);
+    printf("frames: %u, score: %u, level: %u\n", frames, score, level);
+    printf("glyph cache hits: %u, misses: %u\n", hits, misses);
+    printf("button polygon cycles: %u, sprite cycles: %u\n", button_polygon_cycles, button_sprite_cycles);
+    printf("touch interrupts: %u, scans: %u, actions: %u, latency avg: %u us, max: %u us\n", input_stats.interrupts,
+        input_stats.scans, input_stats.actions, input_average_latency_us(INPUT_SOURCE_BUTTON),
+        input_stats.latency[INPUT_SOURCE_BUTTON].max_us);
+    printf("logic steps: %u, late: %u, max jitter: %u us, max step: %u us, snapshots rendered: %u, skipped: %u\n",
+        logic_stats.steps, logic_stats.late, logic_stats.max_jitter_us, logic_stats.max_step_us, logic_stats.rendered,
+        logic_stats.skipped);
+    printf("presents: %u, missed: %u, duplicated: %u, present interval min: %u us, max: %u us, dropped frames: %u\n",
+        vsync_stats.presents, vsync_stats.missed, vsync_stats.duplicated, vsync_stats.min_interval_us,
+        vsync_stats.max_interval_us, swapchain_stats.dropped);
+
+    if (image != NULL) {
+        write_ppm(image, swapchain_front_buffer());
+    }
+    return 0;
+}
@@ -91,6 +91,21 @@
   #define UTIL_LCD_MAX_LAYERS_NBR    2U
 #endif
 
+#ifndef UTIL_LCD_LINE_MIN_RUN
+  #define UTIL_LCD_LINE_MIN_RUN 8U
+#endif
+
+#ifndef UTIL_LCD_DIRECT_MAX_SPAN
+  #define UTIL_LCD_DIRECT_MAX_SPAN 64U
+#endif
+
+#ifndef UTIL_LCD_POLYGON_MAX_POINTS
+  #define UTIL_LCD_POLYGON_MAX_POINTS 32U
+#endif
+
+#define UTIL_LCD_GLYPH_CACHE_BUCKETS 64U
+#define UTIL_LCD_GLYPH_NONE          0xFFFFU
+
 /** @defgroup UTIL_LCD_Private_Macros STM32 LCD Utility Private Macros
   * @{
   */
@@ -115,13 +130,44 @@
   */
 typedef struct
 {
-  uint32_t x1;
-  uint32_t y1;
-  uint32_t x2;
-  uint32_t y2;
-  uint32_t x3;
-  uint32_t y3;
-}Triangle_Positions_t;
+  int32_t X0;      /* Upper end point */
+  int32_t Y0;
+  int32_t DX;      /* Towards the lower end point */
+  int32_t DY;      /* Always positive, horizontal edges are left out */
+}Polygon_Edge_t;
+
+typedef struct
+{
+  int32_t Left;    /* First pixel */
+  int32_t Right;   /* Pixel after the last one */
+  int32_t Top;     /* First scanline the span was found on */
+}Polygon_Span_t;
+
+typedef struct
+{
+  const sFONT *pFont;       /*!< Font the glyph was expanded from */
+  uint32_t     TextColor;
+  uint32_t     BackColor;
+  uint32_t     PixelFormat; /*!< Pixel format of the expanded glyph */
+  uint8_t      Ascii;
+  uint16_t     HashNext;    /*!< Next entry in the same hash bucket */
+  uint16_t     Prev;        /*!< Neighbour towards the most recently used entry */
+  uint16_t     Next;        /*!< Neighbour towards the least recently used entry */
+}Glyph_Entry_t;
+
+typedef struct
+{
+  uint8_t      *pBuffer;    /*!< Expanded glyph pixels, one UTIL_LCD_GLYPH_SLOT_SIZE slot per entry */
+  UTIL_LCD_GlyphRelease_t Release; /*!< Called with a slot before it is reused, NULL if nothing reads it later */
+  uint16_t      Capacity;
+  uint16_t      Count;
+  uint16_t      Head;       /*!< Most recently used entry */
+  uint16_t      Tail;       /*!< Least recently used entry, evicted first */
+  uint32_t      Hits;
+  uint32_t      Misses;
+  uint16_t      Bucket[UTIL_LCD_GLYPH_CACHE_BUCKETS];
+  Glyph_Entry_t Entry[UTIL_LCD_GLYPH_CACHE_ENTRIES];
+}Glyph_Cache_t;
 
 /**
   * @}
@@ -137,6 +183,23 @@ typedef struct
 static UTIL_LCD_Ctx_t DrawProp[UTIL_LCD_MAX_LAYERS_NBR];
 static LCD_UTILS_Drv_t FuncDriver;
 
+/**
+  * @brief  Expanded glyphs keyed by font, character, colors and pixel format
+  */
+static Glyph_Cache_t GlyphCache;
+
+/**
+  * @brief  ARGB8888 color of every index drawn in the L8 pixel format
+  */
+static const uint32_t *Palette;
+static uint32_t PaletteSize;
+
+/**
+  * @brief  Frame buffer of the active layer written by the CPU, pAddress is NULL when every pixel goes
+  *         through the driver
+  */
+static LCD_UTILS_FrameBuffer_t FrameBuffer;
+
 /**
   * @}
   */
@@ -144,8 +207,16 @@ static LCD_UTILS_Drv_t FuncDriver;
 /** @defgroup UTIL_LCD_Private_FunctionPrototypes STM32 LCD Utility Private FunctionPrototypes
   * @{
   */
-static void DrawChar(uint32_t Xpos, uint32_t Ypos, const uint8_t *pData);
-static void FillTriangle(Triangle_Positions_t *Positions, uint32_t Color);
+static void DrawChar(uint32_t Xpos, uint32_t Ypos, uint8_t Ascii, const uint8_t *pData);
+static uint8_t *GetGlyph(uint8_t Ascii, const uint8_t *pData);
+static void ExpandGlyph(const uint8_t *pData, uint8_t *pDst, uint32_t Stride);
+static uint32_t ConvertColor(uint32_t Color);
+static uint32_t PixelSize(void);
+static void PutPixel(uint8_t *pDst, uint32_t Color);
+static int32_t CrossingPixel(const Polygon_Edge_t *Edge, int32_t Y);
+static void DrawRun(int32_t Xpos, int32_t Ypos, int32_t Step, uint32_t Length, uint32_t Horizontal, uint32_t Color);
+static void DirectSpan(uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Horizontal, uint32_t Color);
+static void SyncLines(int32_t Ypos, uint32_t Height);
 /**
   * @}
   */
@@ -171,12 +242,32 @@ void UTIL_LCD_SetFuncDriver(const LCD_UTILS_Drv_t *pDrv)
   FuncDriver.GetYSize       = pDrv->GetYSize;
   FuncDriver.SetLayer       = pDrv->SetLayer;
   FuncDriver.GetFormat      = pDrv->GetFormat;
+  FuncDriver.GetFrameBuffer = pDrv->GetFrameBuffer;
+  FuncDriver.Sync           = pDrv->Sync;
 
   DrawProp->LcdLayer = 0;
   DrawProp->LcdDevice = 0;
   FuncDriver.GetXSize(0, &DrawProp->LcdXsize);
   FuncDriver.GetYSize(0, &DrawProp->LcdYsize);
   FuncDriver.GetFormat(0, &DrawProp->LcdPixelFormat);
+  UTIL_LCD_BeginFrame();
+}
+
+/**
+  * @brief  Looks up the frame buffer of the active layer, pixels and lines up to UTIL_LCD_DIRECT_MAX_SPAN
+  *         are then written into it directly. Called whenever the address of the layer changes.
+  */
+void UTIL_LCD_BeginFrame(void)
+{
+  FrameBuffer.pAddress = NULL;
+  if((FuncDriver.GetFrameBuffer != NULL) && (FuncDriver.Sync != NULL))
+  {
+    if((FuncDriver.GetFrameBuffer(DrawProp->LcdDevice, &FrameBuffer) != 0) ||
+       (FrameBuffer.PixelFormat != DrawProp->LcdPixelFormat))
+    {
+      FrameBuffer.pAddress = NULL;
+    }
+  }
 }
 
 /**
@@ -190,6 +281,7 @@ void UTIL_LCD_SetLayer(uint32_t Layer)
     if(FuncDriver.SetLayer(DrawProp->LcdDevice, Layer) == 0)
     {
       DrawProp->LcdLayer = Layer;
+      UTIL_LCD_BeginFrame();
     }
   }
 }
@@ -203,6 +295,7 @@ void UTIL_LCD_SetDevice(uint32_t Device)
   DrawProp->LcdDevice = Device;
   FuncDriver.GetXSize(Device, &DrawProp->LcdXsize);
   FuncDriver.GetYSize(Device, &DrawProp->LcdYsize);
+  UTIL_LCD_BeginFrame();
 }
 
 /**
@@ -281,14 +374,15 @@ void UTIL_LCD_FillRGBRect(uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t
   */
 void UTIL_LCD_DrawHLine(uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
 {
-  /* Write line */
-  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
+  if((FrameBuffer.pAddress != NULL) && (Length <= UTIL_LCD_DIRECT_MAX_SPAN))
   {
-    FuncDriver.DrawHLine(DrawProp->LcdDevice, Xpos, Ypos, Length, CONVERTARGB88882RGB565(Color));
+    SyncLines((int32_t)Ypos, 1U);
+    DirectSpan(Xpos, Ypos, Length, 1U, ConvertColor(Color));
   }
   else
   {
-    FuncDriver.DrawHLine(DrawProp->LcdDevice, Xpos, Ypos, Length, Color);
+    /* Write line */
+    FuncDriver.DrawHLine(DrawProp->LcdDevice, Xpos, Ypos, Length, ConvertColor(Color));
   }
 }
 
@@ -301,14 +395,15 @@ void UTIL_LCD_DrawHLine(uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t
   */
 void UTIL_LCD_DrawVLine(uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
 {
-  /* Write line */
-  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
+  if((FrameBuffer.pAddress != NULL) && (Length <= UTIL_LCD_DIRECT_MAX_SPAN))
   {
-    FuncDriver.DrawVLine(DrawProp->LcdDevice, Xpos, Ypos, Length, CONVERTARGB88882RGB565(Color));
+    SyncLines((int32_t)Ypos, Length);
+    DirectSpan(Xpos, Ypos, Length, 0U, ConvertColor(Color));
   }
   else
   {
-    FuncDriver.DrawVLine(DrawProp->LcdDevice, Xpos, Ypos, Length, Color);
+    /* Write line */
+    FuncDriver.DrawVLine(DrawProp->LcdDevice, Xpos, Ypos, Length, ConvertColor(Color));
   }
 }
 
@@ -326,6 +421,10 @@ void UTIL_LCD_GetPixel(uint16_t Xpos, uint16_t Ypos, uint32_t *Color)
   {
     *Color = CONVERTRGB5652ARGB8888(*Color);
   }
+  else if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_L8)
+  {
+    *Color = (*Color < PaletteSize) ? Palette[*Color] : 0U;
+  }
 }
 
 /**
@@ -336,14 +435,15 @@ void UTIL_LCD_GetPixel(uint16_t Xpos, uint16_t Ypos, uint32_t *Color)
   */
 void UTIL_LCD_SetPixel(uint16_t Xpos, uint16_t Ypos, uint32_t Color)
 {
-  /* Set Pixel */
-  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
+  if(FrameBuffer.pAddress != NULL)
   {
-    FuncDriver.SetPixel(DrawProp->LcdDevice, Xpos, Ypos, CONVERTARGB88882RGB565(Color));
+    SyncLines((int32_t)Ypos, 1U);
+    DirectSpan(Xpos, Ypos, 1U, 1U, ConvertColor(Color));
   }
   else
   {
-    FuncDriver.SetPixel(DrawProp->LcdDevice, Xpos, Ypos, Color);
+    /* Set Pixel */
+    FuncDriver.SetPixel(DrawProp->LcdDevice, Xpos, Ypos, ConvertColor(Color));
   }
 }
 
@@ -376,10 +476,60 @@ void UTIL_LCD_ClearStringLine(uint32_t Line)
   */
 void UTIL_LCD_DisplayChar(uint32_t Xpos, uint32_t Ypos, uint8_t Ascii)
 {
-  DrawChar(Xpos, Ypos, &DrawProp[DrawProp->LcdLayer].pFont->table[(Ascii-' ') *\
+  DrawChar(Xpos, Ypos, Ascii, &DrawProp[DrawProp->LcdLayer].pFont->table[(Ascii-' ') *\
   DrawProp[DrawProp->LcdLayer].pFont->Height * ((DrawProp[DrawProp->LcdLayer].pFont->Width + 7) / 8)]);
 }
 
+/**
+  * @brief  Sets the memory used to cache expanded glyphs.
+  * @param  pBuffer Cache memory, NULL disables the cache
+  * @param  Size Size of the cache memory in bytes
+  * @param  Release Waits until the queued transfers no longer read a slot, NULL if the driver copies the pixels
+  * @note   Glyphs are expanded once in the frame buffer pixel format and then written
+  *         with a single FillRGBRect, the least recently used glyph is evicted when full.
+  *         A driver that blits straight from the cache may still read an evicted slot,
+  *         Release is called with it before it is overwritten.
+  */
+void UTIL_LCD_SetGlyphCache(uint8_t *pBuffer, uint32_t Size, UTIL_LCD_GlyphRelease_t Release)
+{
+  uint32_t i, capacity = (pBuffer == NULL) ? 0U : (Size / UTIL_LCD_GLYPH_SLOT_SIZE);
+
+  GlyphCache.pBuffer  = pBuffer;
+  GlyphCache.Release  = Release;
+  GlyphCache.Capacity = (capacity > UTIL_LCD_GLYPH_CACHE_ENTRIES) ? UTIL_LCD_GLYPH_CACHE_ENTRIES : capacity;
+  GlyphCache.Count    = 0;
+  GlyphCache.Head     = UTIL_LCD_GLYPH_NONE;
+  GlyphCache.Tail     = UTIL_LCD_GLYPH_NONE;
+  GlyphCache.Hits     = 0;
+  GlyphCache.Misses   = 0;
+  for(i = 0; i < UTIL_LCD_GLYPH_CACHE_BUCKETS; i++)
+  {
+    GlyphCache.Bucket[i] = UTIL_LCD_GLYPH_NONE;
+  }
+}
+
+/**
+  * @brief  Sets the colors of the indices drawn in the L8 pixel format.
+  * @param  pColors ARGB8888 color of every index, colors that are not in it are drawn as index 0
+  * @param  Count Number of colors
+  */
+void UTIL_LCD_SetPalette(const uint32_t *pColors, uint32_t Count)
+{
+  Palette = pColors;
+  PaletteSize = Count;
+}
+
+/**
+  * @brief  Gets the glyph cache hit and miss counters.
+  * @param  Hits Number of glyphs drawn from the cache
+  * @param  Misses Number of glyphs expanded into the cache
+  */
+void UTIL_LCD_GetGlyphCacheStats(uint32_t *Hits, uint32_t *Misses)
+{
+  *Hits   = GlyphCache.Hits;
+  *Misses = GlyphCache.Misses;
+}
+
 /**
   * @brief  Displays characters in currently active layer.
   * @param  Xpos X position (in pixel)
@@ -447,6 +597,38 @@ void UTIL_LCD_DisplayStringAt(uint32_t Xpos, uint32_t Ypos, uint8_t *Text, Text_
   }
 }
 
+/**
+  * @brief  Rasterizes a string into a pixel buffer in the current font, colors and pixel format.
+  * @param  pDst Pointer to the pixel buffer, rows are as wide as the string
+  * @param  Size Size of the pixel buffer in bytes
+  * @param  Text Pointer to the string
+  * @retval Width of the string in pixels, 0 if it does not fit into the buffer
+  */
+uint32_t UTIL_LCD_RasterizeString(uint8_t *pDst, uint32_t Size, uint8_t *Text)
+{
+  sFONT *pfont = DrawProp[DrawProp->LcdLayer].pFont;
+  uint32_t bpp = PixelSize();
+  uint32_t length = 0, width, i;
+
+  while (Text[length] != 0U)
+  {
+    length++;
+  }
+
+  width = length * pfont->Width;
+  if((width * pfont->Height * bpp) > Size)
+  {
+    return 0;
+  }
+
+  for(i = 0; i < length; i++)
+  {
+    ExpandGlyph(&pfont->table[(Text[i] - ' ') * pfont->Height * ((pfont->Width + 7U) / 8U)], pDst + (i * pfont->Width * bpp), width);
+  }
+
+  return width;
+}
+
 /**
   * @brief  Displays a maximum of 60 characters on the LCD.
   * @param  Line: Line where to display the character shape
@@ -458,7 +640,8 @@ void UTIL_LCD_DisplayStringAtLine(uint32_t Line, uint8_t *ptr)
 }
 
 /**
-  * @brief  Draws an uni-line (between two points) in currently active layer.
+  * @brief  Draws an uni-line (between two points) in currently active layer. Consecutive pixels on the same row
+  *         or column are drawn as a single horizontal or vertical line.
   * @param  Xpos1 Point 1 X position
   * @param  Ypos1 Point 1 Y position
   * @param  Xpos2 Point 2 X position
@@ -469,8 +652,9 @@ void UTIL_LCD_DrawLine(uint32_t Xpos1, uint32_t Ypos1, uint32_t Xpos2, uint32_t
 {
   int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0,
   yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0,
-  curpixel = 0;
+  curpixel = 0, run_x = 0, run_y = 0;
   int32_t x_diff, y_diff;
+  uint32_t run_length = 0, horizontal, color = ConvertColor(Color);
 
   x_diff = Xpos2 - Xpos1;
   y_diff = Ypos2 - Ypos1;
@@ -521,9 +705,18 @@ void UTIL_LCD_DrawLine(uint32_t Xpos1, uint32_t Ypos1, uint32_t Xpos2, uint32_t
     numpixels = deltay;         /* There are more y-values than x-values */
   }
 
+  /* Pixels on the same row, or column for steep lines, are collected into runs drawn with one call */
+  horizontal = (deltax >= deltay) ? 1U : 0U;
+  if(FrameBuffer.pAddress != NULL)
+  {
+    /* The runs of the line never overlap, one sync of its lines covers them all */
+    SyncLines((y_diff < 0) ? (int32_t)Ypos2 : (int32_t)Ypos1, (uint32_t)deltay + 1U);
+  }
+  run_x = x;
+  run_y = y;
   for (curpixel = 0; curpixel <= numpixels; curpixel++)
   {
-    UTIL_LCD_SetPixel(x, y, Color);   /* Draw the current pixel */
+    run_length++;                             /* Add the current pixel to the run */
     num += numadd;                            /* Increase the numerator by the top of the fraction */
     if (num >= den)                           /* Check if numerator >= denominator */
     {
@@ -533,6 +726,13 @@ void UTIL_LCD_DrawLine(uint32_t Xpos1, uint32_t Ypos1, uint32_t Xpos2, uint32_t
     }
     x += xinc2;                               /* Change the x as appropriate */
     y += yinc2;                               /* Change the y as appropriate */
+    if ((curpixel == numpixels) || ((horizontal == 1U) ? (y != run_y) : (x != run_x)))
+    {
+      DrawRun(run_x, run_y, (horizontal == 1U) ? xinc2 : yinc2, run_length, horizontal, color);
+      run_x = x;                              /* The next pixel starts a new run */
+      run_y = y;
+      run_length = 0;
+    }
   }
 }
 
@@ -721,14 +921,7 @@ void UTIL_LCD_DrawBitmap(uint32_t Xpos, uint32_t Ypos, uint8_t *pData)
 void UTIL_LCD_FillRect(uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
 {
   /* Fill the rectangle */
-  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
-  {
-    FuncDriver.FillRect(DrawProp->LcdDevice, Xpos, Ypos, Width, Height, CONVERTARGB88882RGB565(Color));
-  }
-  else
-  {
-    FuncDriver.FillRect(DrawProp->LcdDevice, Xpos, Ypos, Width, Height, Color);
-  }
+  FuncDriver.FillRect(DrawProp->LcdDevice, Xpos, Ypos, Width, Height, ConvertColor(Color));
 }
 
 /**
@@ -794,105 +987,127 @@ void UTIL_LCD_FillCircle(uint32_t Xpos, uint32_t Ypos, uint32_t Radius, uint32_t
 }
 
 /**
-  * @brief  Draws a full poly-line (between many points) in currently active layer.
+  * @brief  Fills a polygon in currently active layer. A pixel is filled when its center is inside by the even-odd
+  *         rule, runs of the same span on consecutive scanlines are written with a single rectangle fill.
   * @param  Points     Pointer to the points array
-  * @param  PointCount Number of points
+  * @param  PointCount Number of points, at most UTIL_LCD_POLYGON_MAX_POINTS
   * @param  Color      Draw color
   */
 void UTIL_LCD_FillPolygon(pPoint Points, uint32_t PointCount, uint32_t Color)
 {
-  int16_t X = 0, Y = 0, X2 = 0, Y2 = 0, x_center = 0, y_center = 0, x_first = 0, y_first = 0, pixel_x = 0, pixel_y = 0, counter = 0;
-  uint32_t  image_left = 0, image_right = 0, image_top = 0, image_bottom = 0;
-  Triangle_Positions_t positions;
-
-  image_left = image_right = Points->X;
-  image_top= image_bottom = Points->Y;
+  Polygon_Edge_t edges[UTIL_LCD_POLYGON_MAX_POINTS], edge;
+  Polygon_Span_t pending[UTIL_LCD_POLYGON_MAX_POINTS / 2U], spans[UTIL_LCD_POLYGON_MAX_POINTS / 2U];
+  int32_t crossings[UTIL_LCD_POLYGON_MAX_POINTS];
+  uint32_t edge_count = 0, entered = 0, crossing_count, span_count, pending_count = 0, i, j;
+  int32_t x1, y1, x2, y2, x, y, y_end = 0, left, right;
+  uint32_t color = ConvertColor(Color);
+
+  if((PointCount < 3U) || (PointCount > UTIL_LCD_POLYGON_MAX_POINTS))
+  {
+    return;
+  }
 
-  for(counter = 1; counter < PointCount; counter++)
+  /* Edge table ordered by the first scanline of each edge */
+  for(i = 0; i < PointCount; i++)
   {
-    pixel_x = POLY_X(counter);
-    if(pixel_x < image_left)
+    x1 = Points[i].X;
+    y1 = Points[i].Y;
+    x2 = Points[(i + 1U) % PointCount].X;
+    y2 = Points[(i + 1U) % PointCount].Y;
+    if(y1 == y2)
     {
-      image_left = pixel_x;
+      continue;
     }
-    if(pixel_x > image_right)
+    edge.X0 = (y1 < y2) ? x1 : x2;
+    edge.Y0 = (y1 < y2) ? y1 : y2;
+    edge.DX = (y1 < y2) ? (x2 - x1) : (x1 - x2);
+    edge.DY = (y1 < y2) ? (y2 - y1) : (y1 - y2);
+    if((edge.Y0 + edge.DY) > y_end)
     {
-      image_right = pixel_x;
+      y_end = edge.Y0 + edge.DY;
     }
-
-    pixel_y = POLY_Y(counter);
-    if(pixel_y < image_top)
-    {
-      image_top = pixel_y;
-    }
-    if(pixel_y > image_bottom)
+    for(j = edge_count++; (j > 0U) && (edges[j - 1U].Y0 > edge.Y0); j--)
     {
-      image_bottom = pixel_y;
+      edges[j] = edges[j - 1U];
     }
+    edges[j] = edge;
   }
 
-  if(PointCount < 2)
+  if(edge_count == 0U)
   {
     return;
   }
+  y = (edges[0].Y0 < 0) ? 0 : edges[0].Y0;
+  y_end = (y_end > (int32_t)DrawProp->LcdYsize) ? (int32_t)DrawProp->LcdYsize : y_end;
 
-  x_center = (image_left + image_right)/2;
-  y_center = (image_bottom + image_top)/2;
+  for(; y <= y_end; y++)
+  {
+    span_count = 0;
+    if(y < y_end)
+    {
+      /* Crossings of the scanline through the pixel centers with the active edges, in order */
+      while((entered < edge_count) && (edges[entered].Y0 <= y))
+      {
+        entered++;
+      }
+      crossing_count = 0;
+      for(i = 0; i < entered; i++)
+      {
+        if(y < (edges[i].Y0 + edges[i].DY))
+        {
+          x = CrossingPixel(&edges[i], y);
+          for(j = crossing_count++; (j > 0U) && (crossings[j - 1U] > x); j--)
+          {
+            crossings[j] = crossings[j - 1U];
+          }
+          crossings[j] = x;
+        }
+      }
 
-  x_first = Points->X;
-  y_first = Points->Y;
+      /* Every pair of crossings encloses a span, touching spans are joined */
+      for(i = 0; (i + 1U) < crossing_count; i += 2U)
+      {
+        left = (crossings[i] < 0) ? 0 : crossings[i];
+        right = (crossings[i + 1U] > (int32_t)DrawProp->LcdXsize) ? (int32_t)DrawProp->LcdXsize : crossings[i + 1U];
+        if(left >= right)
+        {
+          continue;
+        }
+        if((span_count != 0U) && (spans[span_count - 1U].Right == left))
+        {
+          spans[span_count - 1U].Right = right;
+        }
+        else
+        {
+          spans[span_count].Left = left;
+          spans[span_count].Right = right;
+          spans[span_count].Top = y;
+          span_count++;
+        }
+      }
+    }
 
-  while(--PointCount)
-  {
-    X = Points->X;
-    Y = Points->Y;
-    Points++;
-    X2 = Points->X;
-    Y2 = Points->Y;
-    positions.x1 = X;
-    positions.y1 = Y;
-    positions.x2 = X2;
-    positions.y2 = Y2;
-    positions.x3 = x_center;
-    positions.y3 = y_center;
-    FillTriangle(&positions, Color);
-
-    positions.x2 = x_center;
-    positions.y2 = y_center;
-    positions.x3 = X2;
-    positions.y3 = Y2;
-    FillTriangle(&positions, Color);
-
-    positions.x1 = x_center;
-    positions.y1 = y_center;
-    positions.x2 = X2;
-    positions.y2 = Y2;
-    positions.x3 = X;
-    positions.y3 = Y;
-    FillTriangle(&positions, Color);
+    /* Spans that continue keep growing, the ones that ended are filled */
+    for(i = 0; i < pending_count; i++)
+    {
+      for(j = 0; (j < span_count) && ((spans[j].Left != pending[i].Left) || (spans[j].Right != pending[i].Right)); j++)
+      {
+      }
+      if(j < span_count)
+      {
+        spans[j].Top = pending[i].Top;
+      }
+      else
+      {
+        FuncDriver.FillRect(DrawProp->LcdDevice, pending[i].Left, pending[i].Top, pending[i].Right - pending[i].Left, y - pending[i].Top, color);
+      }
+    }
+    for(i = 0; i < span_count; i++)
+    {
+      pending[i] = spans[i];
+    }
+    pending_count = span_count;
   }
-
-    positions.x1 = x_first;
-    positions.y1 = y_first;
-    positions.x2 = X2;
-    positions.y2 = Y2;
-    positions.x3 = x_center;
-    positions.y3 = y_center;
-    FillTriangle(&positions, Color);
-
-    positions.x2 = x_center;
-    positions.y2 = y_center;
-    positions.x3 = X2;
-    positions.y3 = Y2;
-    FillTriangle(&positions, Color);
-
-    positions.x1 = x_center;
-    positions.y1 = y_center;
-    positions.x2 = X2;
-    positions.y2 = Y2;
-    positions.x3 = x_first;
-    positions.y3 = y_first;
-    FillTriangle(&positions, Color);
 }
 
 /**
@@ -935,7 +1150,7 @@ void UTIL_LCD_FillEllipse(int Xpos, int Ypos, int XRadius, int YRadius, uint32_t
   * @param  Ypos  Start column address
   * @param  pData Pointer to the character data
   */
-static void DrawChar(uint32_t Xpos, uint32_t Ypos, const uint8_t *pData)
+static void DrawChar(uint32_t Xpos, uint32_t Ypos, uint8_t Ascii, const uint8_t *pData)
 {
   uint32_t i = 0, j = 0, offset;
   uint32_t height, width;
@@ -944,8 +1159,18 @@ static void DrawChar(uint32_t Xpos, uint32_t Ypos, const uint8_t *pData)
 
   height = DrawProp[DrawProp->LcdLayer].pFont->Height;
   width  = DrawProp[DrawProp->LcdLayer].pFont->Width;
-  uint16_t rgb565[24];
-  uint32_t argb8888[24];
+
+  /* Write the whole glyph at once when it can be cached */
+  if((GlyphCache.Capacity != 0U) && ((width * height * 4U) <= UTIL_LCD_GLYPH_SLOT_SIZE))
+  {
+    UTIL_LCD_FillRGBRect(Xpos, Ypos, GetGlyph(Ascii, pData), width, height);
+    return;
+  }
+
+  uint32_t pixels[24];
+  uint32_t text_color = ConvertColor(DrawProp[DrawProp->LcdLayer].TextColor);
+  uint32_t back_color = ConvertColor(DrawProp[DrawProp->LcdLayer].BackColor);
+  uint32_t bpp = PixelSize();
 
   offset =  8 *((width + 7)/8) -  width ;
 
@@ -970,114 +1195,339 @@ static void DrawChar(uint32_t Xpos, uint32_t Ypos, const uint8_t *pData)
       break;
     }
 
-    if(DrawProp[DrawProp->LcdLayer].LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
+    for (j = 0; j < width; j++)
     {
-      for (j = 0; j < width; j++)
-      {
-        if(line & (1 << (width- j + offset- 1)))
-        {
-          rgb565[j] = CONVERTARGB88882RGB565(DrawProp[DrawProp->LcdLayer].TextColor);
-        }
-        else
-        {
-          rgb565[j] = CONVERTARGB88882RGB565(DrawProp[DrawProp->LcdLayer].BackColor);
-        }
-      }
-      UTIL_LCD_FillRGBRect(Xpos,  Ypos++, (uint8_t*)&rgb565[0], width, 1);
+      PutPixel((uint8_t *)pixels + (j * bpp), (line & (1 << (width- j + offset- 1))) ? text_color : back_color);
+    }
+    UTIL_LCD_FillRGBRect(Xpos,  Ypos++, (uint8_t *)pixels, width, 1);
+  }
+}
+
+/**
+  * @brief  Looks up a glyph in the cache and expands it on a miss.
+  * @param  Ascii Character ascii code
+  * @param  pData Pointer to the character font data
+  * @retval Pointer to the expanded glyph pixels
+  */
+static uint8_t *GetGlyph(uint8_t Ascii, const uint8_t *pData)
+{
+  const sFONT *pfont = DrawProp[DrawProp->LcdLayer].pFont;
+  uint32_t text_color = DrawProp[DrawProp->LcdLayer].TextColor;
+  uint32_t back_color = DrawProp[DrawProp->LcdLayer].BackColor;
+  uint32_t format = DrawProp->LcdPixelFormat;
+  uint32_t hash, bucket;
+  uint16_t index, *plink;
+  Glyph_Entry_t *pentry;
+
+  hash = (uint32_t)(uintptr_t)pfont ^ ((uint32_t)Ascii * 0x9E3779B1U) ^ text_color ^ (back_color << 1) ^ format;
+  bucket = (hash ^ (hash >> 16)) % UTIL_LCD_GLYPH_CACHE_BUCKETS;
+
+  for(index = GlyphCache.Bucket[bucket]; index != UTIL_LCD_GLYPH_NONE; index = pentry->HashNext)
+  {
+    pentry = &GlyphCache.Entry[index];
+    if((pentry->pFont == pfont) && (pentry->Ascii == Ascii) && (pentry->TextColor == text_color) &&
+       (pentry->BackColor == back_color) && (pentry->PixelFormat == format))
+    {
+      break;
+    }
+  }
+
+  if(index != UTIL_LCD_GLYPH_NONE)
+  {
+    GlyphCache.Hits++;
+    if(index == GlyphCache.Head)
+    {
+      return &GlyphCache.pBuffer[index * UTIL_LCD_GLYPH_SLOT_SIZE];
+    }
+    /* Unlink from the LRU list, it is linked back in as the most recently used entry */
+    GlyphCache.Entry[pentry->Prev].Next = pentry->Next;
+    if(pentry->Next != UTIL_LCD_GLYPH_NONE)
+    {
+      GlyphCache.Entry[pentry->Next].Prev = pentry->Prev;
+    }
+    else
+    {
+      GlyphCache.Tail = pentry->Prev;
+    }
+  }
+  else
+  {
+    GlyphCache.Misses++;
+    if(GlyphCache.Count < GlyphCache.Capacity)
+    {
+      index = GlyphCache.Count++;
     }
     else
     {
-      for (j = 0; j < width; j++)
+      /* Evict the least recently used glyph */
+      index = GlyphCache.Tail;
+      pentry = &GlyphCache.Entry[index];
+      GlyphCache.Tail = pentry->Prev;
+      if(GlyphCache.Tail != UTIL_LCD_GLYPH_NONE)
       {
-        if(line & (1 << (width- j + offset- 1)))
-        {
-          argb8888[j] = DrawProp[DrawProp->LcdLayer].TextColor;
-        }
-        else
-        {
-          argb8888[j] = DrawProp[DrawProp->LcdLayer].BackColor;
-        }
+        GlyphCache.Entry[GlyphCache.Tail].Next = UTIL_LCD_GLYPH_NONE;
+      }
+      else
+      {
+        GlyphCache.Head = UTIL_LCD_GLYPH_NONE;
+      }
+      hash = (uint32_t)(uintptr_t)pentry->pFont ^ ((uint32_t)pentry->Ascii * 0x9E3779B1U) ^ pentry->TextColor ^ (pentry->BackColor << 1) ^ pentry->PixelFormat;
+      for(plink = &GlyphCache.Bucket[(hash ^ (hash >> 16)) % UTIL_LCD_GLYPH_CACHE_BUCKETS]; *plink != index; plink = &GlyphCache.Entry[*plink].HashNext)
+      {
+      }
+      *plink = pentry->HashNext;
+      if(GlyphCache.Release != NULL)
+      {
+        GlyphCache.Release((uintptr_t)&GlyphCache.pBuffer[index * UTIL_LCD_GLYPH_SLOT_SIZE], UTIL_LCD_GLYPH_SLOT_SIZE);
       }
-      UTIL_LCD_FillRGBRect(Xpos,  Ypos++, (uint8_t*)&argb8888[0], width, 1);
     }
+
+    pentry = &GlyphCache.Entry[index];
+    pentry->pFont       = pfont;
+    pentry->Ascii       = Ascii;
+    pentry->TextColor   = text_color;
+    pentry->BackColor   = back_color;
+    pentry->PixelFormat = format;
+    pentry->HashNext    = GlyphCache.Bucket[bucket];
+    GlyphCache.Bucket[bucket] = index;
+    ExpandGlyph(pData, &GlyphCache.pBuffer[index * UTIL_LCD_GLYPH_SLOT_SIZE], DrawProp[DrawProp->LcdLayer].pFont->Width);
+    if(GlyphCache.Tail == UTIL_LCD_GLYPH_NONE)
+    {
+      GlyphCache.Tail = index;
+    }
+  }
+
+  /* Link as the most recently used entry */
+  pentry->Prev = UTIL_LCD_GLYPH_NONE;
+  pentry->Next = GlyphCache.Head;
+  if(GlyphCache.Head != UTIL_LCD_GLYPH_NONE)
+  {
+    GlyphCache.Entry[GlyphCache.Head].Prev = index;
   }
+  GlyphCache.Head = index;
+
+  return &GlyphCache.pBuffer[index * UTIL_LCD_GLYPH_SLOT_SIZE];
 }
 
 /**
-  * @brief  Fills a triangle (between 3 points).
-  * @param  Positions  pointer to riangle coordinates
-  * @param  Color      Draw color
+  * @brief  Expands a 1 bpp glyph into pixels in the current text colors and pixel format.
+  * @param  pData Pointer to the character font data
+  * @param  pDst Pointer to the expanded pixels
+  * @param  Stride Number of pixels between the starts of two rows in pDst
   */
-static void FillTriangle(Triangle_Positions_t *Positions, uint32_t Color)
+static void ExpandGlyph(const uint8_t *pData, uint8_t *pDst, uint32_t Stride)
 {
-  int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0,
-  yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0,
-  curpixel = 0;
-  int32_t x_diff, y_diff;
+  uint32_t i, j, line;
+  uint32_t text_color = ConvertColor(DrawProp[DrawProp->LcdLayer].TextColor);
+  uint32_t back_color = ConvertColor(DrawProp[DrawProp->LcdLayer].BackColor);
+  uint32_t bpp = PixelSize();
+  uint32_t height = DrawProp[DrawProp->LcdLayer].pFont->Height;
+  uint32_t width  = DrawProp[DrawProp->LcdLayer].pFont->Width;
+  uint32_t bytes  = (width + 7U) / 8U;
+  uint32_t offset = (8U * bytes) - width;
+  const uint8_t *pchar;
 
-  x_diff = Positions->x2 - Positions->x1;
-  y_diff = Positions->y2 - Positions->y1;
+  for(i = 0; i < height; i++)
+  {
+    pchar = pData + (bytes * i);
+    line = pchar[0];
+    for(j = 1; j < bytes; j++)
+    {
+      line = (line << 8) | pchar[j];
+    }
 
-  deltax = ABS(x_diff);         /* The absolute difference between the x's */
-  deltay = ABS(y_diff);         /* The absolute difference between the y's */
-  x = Positions->x1;                       /* Start x off at the first pixel */
-  y = Positions->y1;                       /* Start y off at the first pixel */
+    for(j = 0; j < width; j++)
+    {
+      PutPixel(pDst + (j * bpp), (line & (1UL << (width - j + offset - 1U))) ? text_color : back_color);
+    }
+    pDst += bpp * Stride;
+  }
+}
 
-  if (Positions->x2 >= Positions->x1)                 /* The x-values are increasing */
+/**
+  * @brief  Converts an ARGB8888 color to the current pixel format.
+  * @param  Color ARGB8888 color
+  * @retval Color in the pixel format, the palette index of the color for L8
+  */
+static uint32_t ConvertColor(uint32_t Color)
+{
+  uint32_t i;
+
+  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_RGB565)
   {
-    xinc1 = 1;
-    xinc2 = 1;
+    return CONVERTARGB88882RGB565(Color);
   }
-  else                          /* The x-values are decreasing */
+  if(DrawProp->LcdPixelFormat == LCD_PIXEL_FORMAT_L8)
   {
-    xinc1 = -1;
-    xinc2 = -1;
+    for(i = 0; i < PaletteSize; i++)
+    {
+      if(Palette[i] == Color)
+      {
+        return i;
+      }
+    }
+    return 0;
   }
+  return Color;
+}
 
-  if (Positions->y2 >= Positions->y1)                 /* The y-values are increasing */
+/**
+  * @brief  Gets the size of a pixel in the current pixel format.
+  * @retval Size in bytes
+  */
+static uint32_t PixelSize(void)
+{
+  switch(DrawProp->LcdPixelFormat)
   {
-    yinc1 = 1;
-    yinc2 = 1;
+  case LCD_PIXEL_FORMAT_RGB565:
+    return 2U;
+  case LCD_PIXEL_FORMAT_L8:
+    return 1U;
+  default:
+    return 4U;
   }
-  else                          /* The y-values are decreasing */
+}
+
+/**
+  * @brief  Stores a pixel in the current pixel format.
+  * @param  pDst Pointer to the pixel
+  * @param  Color Color already converted to the pixel format
+  */
+static void PutPixel(uint8_t *pDst, uint32_t Color)
+{
+  switch(DrawProp->LcdPixelFormat)
   {
-    yinc1 = -1;
-    yinc2 = -1;
+  case LCD_PIXEL_FORMAT_RGB565:
+    *(uint16_t *)pDst = (uint16_t)Color;
+    break;
+  case LCD_PIXEL_FORMAT_L8:
+    *pDst = (uint8_t)Color;
+    break;
+  default:
+    *(uint32_t *)pDst = Color;
+    break;
   }
+}
 
-  if (deltax >= deltay)         /* There is at least one x-value for every y-value */
+/**
+  * @brief  Draws a run of pixels of a line. Runs up to UTIL_LCD_DIRECT_MAX_SPAN are written directly into the
+  *         frame buffer, which must be synced, without it runs shorter than UTIL_LCD_LINE_MIN_RUN are drawn pixel
+  *         by pixel through the driver.
+  * @param  Xpos       X position of the first pixel of the run
+  * @param  Ypos       Y position of the first pixel of the run
+  * @param  Step       Direction of the run, 1 or -1
+  * @param  Length     Number of pixels
+  * @param  Horizontal 1 if the run is on a row, 0 if it is on a column
+  * @param  Color      Color already converted to the pixel format
+  */
+static void DrawRun(int32_t Xpos, int32_t Ypos, int32_t Step, uint32_t Length, uint32_t Horizontal, uint32_t Color)
+{
+  int32_t start = ((Horizontal == 1U) ? Xpos : Ypos) - ((Step < 0) ? (int32_t)(Length - 1U) : 0);
+  uint32_t i;
+
+  if((FrameBuffer.pAddress != NULL) && (Length <= UTIL_LCD_DIRECT_MAX_SPAN))
   {
-    xinc1 = 0;                  /* Don't change the x when numerator >= denominator */
-    yinc2 = 0;                  /* Don't change the y for every iteration */
-    den = deltax;
-    num = deltax / 2;
-    numadd = deltay;
-    numpixels = deltax;         /* There are more x-values than y-values */
+    DirectSpan((Horizontal == 1U) ? start : Xpos, (Horizontal == 1U) ? Ypos : start, Length, Horizontal, Color);
   }
-  else                          /* There is at least one y-value for every x-value */
+  else if(Length < UTIL_LCD_LINE_MIN_RUN)
   {
-    xinc2 = 0;                  /* Don't change the x for every iteration */
-    yinc1 = 0;                  /* Don't change the y when numerator >= denominator */
-    den = deltay;
-    num = deltay / 2;
-    numadd = deltax;
-    numpixels = deltay;         /* There are more y-values than x-values */
+    for(i = 0; i < Length; i++)
+    {
+      FuncDriver.SetPixel(DrawProp->LcdDevice, (Horizontal == 1U) ? (start + (int32_t)i) : Xpos, (Horizontal == 1U) ? Ypos : (start + (int32_t)i), Color);
+    }
+  }
+  else if(Horizontal == 1U)
+  {
+    FuncDriver.DrawHLine(DrawProp->LcdDevice, start, Ypos, Length, Color);
+  }
+  else
+  {
+    FuncDriver.DrawVLine(DrawProp->LcdDevice, Xpos, start, Length, Color);
   }
+}
 
-  for (curpixel = 0; curpixel <= numpixels; curpixel++)
+/**
+  * @brief  Writes a horizontal or vertical span into the frame buffer, the part outside of the layer is skipped.
+  * @param  Xpos       X position of the first pixel
+  * @param  Ypos       Y position of the first pixel
+  * @param  Length     Number of pixels
+  * @param  Horizontal 1 if the span is on a row, 0 if it is on a column
+  * @param  Color      Color already converted to the pixel format
+  */
+static void DirectSpan(uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Horizontal, uint32_t Color)
+{
+  uint8_t *pDst;
+  uint32_t step, i;
+
+  if((Xpos >= DrawProp->LcdXsize) || (Ypos >= DrawProp->LcdYsize))
+  {
+    return;
+  }
+  if(Horizontal == 1U)
   {
-    UTIL_LCD_DrawLine(x, y, Positions->x3, Positions->y3, Color);
+    Length = ((Xpos + Length) > DrawProp->LcdXsize) ? (DrawProp->LcdXsize - Xpos) : Length;
+    step = PixelSize();
+  }
+  else
+  {
+    Length = ((Ypos + Length) > DrawProp->LcdYsize) ? (DrawProp->LcdYsize - Ypos) : Length;
+    step = FrameBuffer.Stride;
+  }
+
+  pDst = FrameBuffer.pAddress + (Ypos * FrameBuffer.Stride) + (Xpos * PixelSize());
+  for(i = 0; i < Length; i++)
+  {
+    PutPixel(pDst, Color);
+    pDst += step;
+  }
+}
 
-    num += numadd;              /* Increase the numerator by the top of the fraction */
-    if (num >= den)             /* Check if numerator >= denominator */
+/**
+  * @brief  Waits until the queued transfers of the driver are done with the lines of the layer that are about to be
+  *         written directly, the part outside of the layer is skipped.
+  * @param  Ypos    First line, may be negative
+  * @param  Height  Number of lines
+  */
+static void SyncLines(int32_t Ypos, uint32_t Height)
+{
+  if(Ypos < 0)
+  {
+    if(Height <= (uint32_t)(-Ypos))
     {
-      num -= den;               /* Calculate the new numerator value */
-      x += xinc1;               /* Change the x as appropriate */
-      y += yinc1;               /* Change the y as appropriate */
+      return;
     }
-    x += xinc2;                 /* Change the x as appropriate */
-    y += yinc2;                 /* Change the y as appropriate */
+    Height -= (uint32_t)(-Ypos);
+    Ypos = 0;
+  }
+  if((uint32_t)Ypos >= DrawProp->LcdYsize)
+  {
+    return;
+  }
+  if(Height > (DrawProp->LcdYsize - (uint32_t)Ypos))
+  {
+    Height = DrawProp->LcdYsize - (uint32_t)Ypos;
+  }
+  FuncDriver.Sync(DrawProp->LcdDevice, (uint32_t)Ypos, Height);
+}
+
+/**
+  * @brief  Finds the first pixel whose center is right of the crossing of an edge with a scanline.
+  * @param  Edge  Polygon edge that crosses the scanline
+  * @param  Y     Scanline, crossed at its pixel centers
+  * @retval X position of the pixel
+  */
+static int32_t CrossingPixel(const Polygon_Edge_t *Edge, int32_t Y)
+{
+  /* The crossing is at X0 + (Y + 1/2 - Y0) * DX / DY, the pixel is the ceiling of the crossing minus 1/2 */
+  int64_t num = ((2 * (int64_t)Edge->X0 - 1) * Edge->DY) + ((2 * (int64_t)(Y - Edge->Y0) + 1) * Edge->DX);
+  int64_t den = 2 * (int64_t)Edge->DY;
+  int64_t pixel = num / den;
+
+  if(((num % den) != 0) && (num > 0))
+  {
+    pixel++;
   }
+  return (int32_t)pixel;
 }
 
 /**
@@ -98,6 +98,14 @@ extern "C" {
   */
 #define UTIL_LCD_DEFAULT_FONT        Font24
 
+/**
+  * @brief LCD Utility glyph cache geometry, one slot holds the largest font glyph
+  */
+#define UTIL_LCD_GLYPH_SLOT_SIZE     (24U * 24U * 4U)
+#ifndef UTIL_LCD_GLYPH_CACHE_ENTRIES
+#define UTIL_LCD_GLYPH_CACHE_ENTRIES 128U
+#endif
+
   /**
     * @}
     */
@@ -143,6 +151,11 @@ extern "C" {
       */
     typedef Point* pPoint;
 
+    /**
+      * @brief  Waits until the queued transfers no longer read the memory, called before a cached glyph is overwritten
+      */
+    typedef void (*UTIL_LCD_GlyphRelease_t)(uintptr_t Address, uint32_t Size);
+
     /**
       * @brief  LCD Utility drawing Line alignment mode definitions
       */
@@ -164,6 +177,7 @@ extern "C" {
 
     void     UTIL_LCD_SetLayer(uint32_t Layer);
     void     UTIL_LCD_SetDevice(uint32_t Device);
+    void     UTIL_LCD_BeginFrame(void);
 
     void     UTIL_LCD_SetTextColor(uint32_t Color);
     uint32_t UTIL_LCD_GetTextColor(void);
@@ -177,6 +191,10 @@ extern "C" {
     void     UTIL_LCD_DisplayStringAtLine(uint32_t Line, uint8_t* ptr);
     void     UTIL_LCD_DisplayStringAt(uint32_t Xpos, uint32_t Ypos, uint8_t* Text, Text_AlignModeTypdef Mode);
     void     UTIL_LCD_DisplayChar(uint32_t Xpos, uint32_t Ypos, uint8_t Ascii);
+    uint32_t UTIL_LCD_RasterizeString(uint8_t* pDst, uint32_t Size, uint8_t* Text);
+    void     UTIL_LCD_SetGlyphCache(uint8_t* pBuffer, uint32_t Size, UTIL_LCD_GlyphRelease_t Release);
+    void     UTIL_LCD_GetGlyphCacheStats(uint32_t* Hits, uint32_t* Misses);
+    void     UTIL_LCD_SetPalette(const uint32_t* pColors, uint32_t Count);
     void     UTIL_LCD_GetPixel(uint16_t Xpos, uint16_t Ypos, uint32_t* Color);
     void     UTIL_LCD_SetPixel(uint16_t Xpos, uint16_t Ypos, uint32_t Color);
     void     UTIL_LCD_FillRGBRect(uint32_t Xpos, uint32_t Ypos, uint8_t* pData, uint32_t Width, uint32_t Height);